@@ -7,11 +7,15 @@
 #include "../Token/Token.hpp"
 #include "BancorConverter.hpp"
 
+#include "src/batch.cpp"
 #include "src/convert.cpp"
 #include "src/converters.cpp"
 #include "src/modify_balance.cpp"
 #include "src/on_notify.cpp"
+#include "src/oracle.cpp"
 #include "src/reserves.cpp"
 #include "src/settings.cpp"
+#include "src/state.cpp"
 #include "src/utils.cpp"
 #include "src/log.cpp"
+#include "src/migrate.cpp"
@@ -10,8 +10,15 @@
 #include <eosio/transaction.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/symbol.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/system.hpp>
+
+#include <algorithm>
+#include <optional>
 
 #include "../Common/common.hpp"
+#include "../Common/return_value.hpp"
+#include "../Common/curves.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -54,6 +61,162 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
             asset       balance;
         };
 
+        /**
+         * ## STRUCT `conversion_result`
+         *
+         * returned (packed) from every conversion through `set_action_return_value`,
+         * so that the fill can be confirmed from the transaction trace
+         *
+         * ### params
+         *
+         * - `{asset} amount` - amount received for the conversion
+         * - `{asset} to_return` - amount returned by the conversion
+         * - `{asset} fee` - conversion fee, in the returned token
+         * - `{vector<extended_asset>} reserve_balances` - balances of the converter's reserves after the conversion
+         */
+        struct conversion_result {
+            asset                   amount;
+            asset                   to_return;
+            asset                   fee;
+            vector<extended_asset>  reserve_balances;
+        };
+
+        /**
+         * ## STRUCT `event_settings`
+         *
+         * chooses which `price_data` events a converter sends, set with `setevents`
+         *
+         * ### params
+         *
+         * - `{name} mode` - `full` (an event for every reserve balance change), `conversion` (one event per conversion,
+         *   for the reserve it changed last)
+         *   or `threshold` (an event for a reserve only when its price moved by `threshold` since its last event)
+         * - `{uint64_t} threshold` - price change in ppm, only used by `threshold`
+         * - `{map<symbol_code, double>} last_prices` - reserve prices of the last `price_data` events, only used by `threshold`
+         *
+         * ### example
+         *
+         * ```json
+         * {
+         *     "mode": "threshold",
+         *     "threshold": 5000,
+         *     "last_prices": [{ "key": "BNT", "value": 0.8172 }]
+         * }
+         * ```
+         */
+        struct event_settings {
+            name                        mode;
+            uint64_t                    threshold;
+            map<symbol_code, double>    last_prices;
+        };
+
+        /**
+         * ## STRUCT `reserve_record`
+         *
+         * a reserve as stored in `converters_t::reserves`
+         *
+         * ### params
+         *
+         * - `{symbol_code} symbol` - reserve token symbol code, the records are sorted by it
+         * - `{uint64_t} weight` - reserve weight relative to the other reserves
+         * - `{extended_asset} balance` - amount in the reserve and the reserve token contract
+         *
+         * ### example
+         *
+         * ```json
+         * {
+         *     "symbol": "BNT",
+         *     "weight": 500000,
+         *     "balance": { "quantity": "10000.00000000 BNT", "contract": "bntbntbntbnt" }
+         * }
+         * ```
+         */
+        struct reserve_record {
+            symbol_code     symbol;
+            uint64_t        weight;
+            extended_asset  balance;
+        };
+
+        /**
+         * ## STRUCT `converter_state`
+         *
+         * the pricing state of a converter returned by `getstate`, fields that weren't requested are left empty
+         *
+         * ### params
+         *
+         * - `{symbol} currency` - smart token symbol
+         * - `{optional<uint64_t>} fee` - conversion fee
+         * - `{optional<vector<reserve_record>>} reserves` - reserves, sorted by symbol
+         * - `{optional<asset>} supply` - smart token supply
+         * - `{optional<uint64_t>} version` - state version, 0 for converters that haven't changed since versions were added
+         */
+        struct converter_state {
+            symbol                                currency;
+            std::optional<uint64_t>               fee;
+            std::optional<vector<reserve_record>> reserves;
+            std::optional<asset>                  supply;
+            std::optional<uint64_t>               version;
+        };
+
+        /**
+         * ## STRUCT `state_page`
+         *
+         * returned (packed) from `getstate`
+         *
+         * ### params
+         *
+         * - `{vector<converter_state>} converters` - converters in primary key order
+         * - `{uint64_t} next` - cursor of the next page, 0 once the last converter was returned
+         */
+        struct state_page {
+            vector<converter_state> converters;
+            uint64_t                next;
+        };
+
+        /**
+         * ## STRUCT `price_observation`
+         *
+         * cumulative prices of a converter's reserves at a block, in `oracle_t`
+         *
+         * ### params
+         *
+         * - `{time_point} timestamp` - block time of the observation
+         * - `{vector<double>} cumulatives` - sums of the smart token price in every reserve (`oracle_t::reserves` order)
+         *   weighted by the seconds it held, since the first observation
+         */
+        struct price_observation {
+            time_point      timestamp;
+            vector<double>  cumulatives;
+        };
+
+        /**
+         * ## STRUCT `twap_result`
+         *
+         * returned (packed) from `gettwap`
+         *
+         * ### params
+         *
+         * - `{time_point} start` - start of the averaged period, `window` seconds ago or the latest observation before that
+         * - `{time_point} end` - end of the averaged period, the current block time
+         * - `{map<symbol_code, double>} prices` - time-weighted average price of the smart token in every reserve,
+         *   the same price as `price_data`'s `reserve_balance / (smart_supply * reserve_ratio)`
+         *
+         * ### example
+         *
+         * ```json
+         * {
+         *     "start": "2020-03-01T12:00:00.000",
+         *     "end": "2020-03-01T12:30:00.500",
+         *     "prices": [{ "key": "BNT", "value": 2.0142 }, { "key": "EOS", "value": 0.4871 }]
+         * }
+         * ```
+         */
+        struct twap_result {
+            time_point                  start;
+            time_point                  end;
+            map<symbol_code, double>    prices;
+        };
+
         /**
          * @defgroup BancorConverter_Settings_Table Settings Table
          * @brief This table stores the global settings affecting all the converters in this contract
@@ -107,6 +270,7 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
 
                 /**
                  * @brief reserve weights relative to the other reserves
+                 * @details legacy, empty once the converter's reserves moved to `reserves`
                  * @example
                  * {
                  *   "key: "BNT",
@@ -117,6 +281,7 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
 
                 /**
                  * @brief balances in each reserve
+                 * @details legacy, empty once the converter's reserves moved to `reserves`
                  * @example
                  * {
                  *   "key: "BNT",
@@ -145,6 +310,29 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
                  */
                 map<name, string> metadata_json;
 
+                /**
+                 * @brief supply of the smart token, mirrored in the same code paths that issue and retire it
+                 * @details converters created before this field existed get it from the multi-token `stat` table on their next update
+                 */
+                binary_extension<asset> supply;
+
+                /**
+                 * @brief [optional] which `price_data` events the converter sends, converters without it send all of them
+                 */
+                binary_extension<event_settings> events;
+
+                /**
+                 * @brief [optional] version of the converter's state, bumped by every change of its reserves or fee
+                 * @details off-chain quotes of a converter stay valid while its version doesn't change, converters without it are at version 0
+                 */
+                binary_extension<uint64_t> version;
+
+                /**
+                 * @brief [optional] reserves of the converter sorted by symbol, replacing `reserve_weights` and `reserve_balances`
+                 * @details the reserves move out of the maps with the `reserves` migration task or the converter's next change
+                 */
+                binary_extension<vector<reserve_record>> reserves;
+
                 /*! \cond DOCS_EXCLUDE */
                 uint64_t primary_key() const { return currency.code().raw(); }
                 /*! \endcond */
@@ -186,6 +374,112 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
 
             }; /** @}*/
 
+        /**
+         * @defgroup BancorConverter_Oracles_Table Oracles Table
+         * @brief This table stores the cumulative prices of every converter, the time-weighted average prices read by `gettwap`
+         * @details SCOPE of this table is `_self`, PRIMARY KEY is `currency.raw()`; a converter's row is paid by its owner,
+         * created by `setreserve` and started over whenever the reserves change
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            struct [[eosio::table("oracles")]] oracle_t { /*! \endcond */
+                /**
+                 * @brief symbol code of the converter's smart token
+                 */
+                symbol_code currency;
+
+                /**
+                 * @brief reserves of the observed prices, the observations start over when they change
+                 */
+                vector<symbol_code> reserves;
+
+                /**
+                 * @brief cumulative prices as of the last block that changed the converter's balances or supply
+                 */
+                price_observation last;
+
+                /**
+                 * @brief slot of `observations` written next
+                 */
+                uint32_t next;
+
+                /**
+                 * @brief ring buffer of `ORACLE_SIZE` copies of `last`, at least `ORACLE_PERIOD` seconds apart,
+                 * the slots not written yet have a null `timestamp`
+                 */
+                vector<price_observation> observations;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return currency.raw(); }
+                /*! \endcond */
+
+            }; /** @}*/
+
+        /**
+         * @defgroup BancorConverter_Orders_Table Orders Table
+         * @brief This table queues the conversions of converters in batch mode until `settle` settles them at one price
+         * @details SCOPE of this table is the converter's smart token symbol's `code().raw()` value, PRIMARY KEY is `id`
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            struct [[eosio::table("orders")]] order_t { /*! \endcond */
+                /**
+                 * @brief sequence number of the order, orders are settled in this order
+                 */
+                uint64_t id;
+
+                /**
+                 * @brief amount sold, in one of the converter's reserves
+                 */
+                extended_asset quantity;
+
+                /**
+                 * @brief conversion memo, its last hop is through this converter
+                 */
+                string memo;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return id; }
+                /*! \endcond */
+
+            }; /** @}*/
+
+        /**
+         * @defgroup BancorConverter_Migrations_Table Migrations Table
+         * @brief This table stores the progress of the maintenance actions that run in bounded chunks (`migrate`, `cleartables`)
+         * @details SCOPE of this table is `_self`, PRIMARY KEY is `task.value`
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            struct [[eosio::table("migrations")]] migration_t { /*! \endcond */
+                /**
+                 * @brief migration task, or `cleartables`
+                 */
+                name task;
+
+                /**
+                 * @brief scope the task runs over, the cleared converter's `currency.raw()` for `cleartables`
+                 */
+                uint64_t scope;
+
+                /**
+                 * @brief primary key of the next row to process
+                 */
+                uint64_t cursor;
+
+                /**
+                 * @brief number of rows processed so far
+                 */
+                uint64_t processed;
+
+                /**
+                 * @brief true once every row was processed
+                 */
+                bool done;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return task.value; }
+                /*! \endcond */
+
+            }; /** @}*/
+
         /**
          * @brief initializes a new converter
          * @param owner - the converter creator
@@ -222,6 +516,11 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
 
         /**
          * @brief may only set staking/voting contract for this multi-converter once
+         * @details protocol features:
+         * - `stake` - the fee is set by the staking contract
+         * - `batch` - final reserve --> reserve conversions are queued and settled together by `settle` at one price,
+         *   only for converters with two reserves; up to `MAX_ORDERS` orders of at least `MIN_ORDER_PPM` of the sold
+         *   reserve's balance are queued, and it can only be disabled once the queue is settled
          * @param currency - currency converter symbol code
          * @param protocol_feature - protocol feature
          * @param enabled - (true/false) to be enabled
@@ -229,7 +528,7 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         [[eosio::action]]
         void activate( const symbol_code currency, const name protocol_feature, const bool enabled );
 
-        // the 4 actions below updates the converter settings, can only be called by the converter owner after creation
+        // the 5 actions below updates the converter settings, can only be called by the converter owner after creation
 
         /**
          * @brief change converter's owner
@@ -247,8 +546,20 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         [[eosio::action]]
         void updatefee(symbol_code currency, uint64_t fee);
 
+        /**
+         * @brief chooses which `price_data` events the converter sends
+         * @details pools with frequent conversions can drop the events nobody reads, the `conversion` event is always sent
+         * and `conversion` mode still sends one `price_data` per conversion, funding and liquidation send none
+         * @param currency - the currency symbol governed by the converter
+         * @param mode - `full`, `conversion` or `threshold`
+         * @param threshold - price change in ppm that triggers an event in `threshold` mode, 1-1000000
+         */
+        [[eosio::action]]
+        void setevents(symbol_code currency, name mode, uint64_t threshold);
+
         /**
          * @brief initializes a new reserve in the converter
+         * @details the converter's price observations start over, in an `oracles` row paid by the owner
          * @param converter_currency_code - the currency code of the currency governed by the converter
          * @param currency - reserve token currency symbol
          * @param contract - reserve token contract name
@@ -266,7 +577,8 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         void delreserve(const symbol_code converter, const symbol_code reserve);
 
         /**
-         * @brief called by liquidity providers withdrawing "temporary balances" before `fund`ing them into the reserve
+         * @brief called by liquidity providers withdrawing "temporary balances" before `fund`ing them into the reserve,
+         * and by the destinations and refunded traders of settled batch conversions
          * @param sender - sender of the quantity
          * @param quantity - amount to decrease the supply by (in the smart token)
          * @param converter_currency_code - the currency code of the currency governed by the converter
@@ -298,6 +610,64 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         [[eosio::on_notify("*::transfer")]]
         void on_transfer(name from, name to, asset quantity, string memo);
 
+        /**
+         * @brief migrates up to `limit` converters, continuing from the cursor saved by the previous call
+         * @details the progress is saved in the `migrations` table and returned (packed `migration_t`),
+         * the task is complete once `done` is set
+         * - `supply` - mirrors the smart token supply in converters created before it was cached in the row
+         * - `reserves` - moves the reserves of converters created before they were kept flat out of the legacy maps
+         * @param task - migration task
+         * @param limit - maximum number of converters to process in this call
+         */
+        [[eosio::action]]
+        void migrate( const name task, const uint64_t limit );
+
+        /**
+         * @brief erases up to `limit` rows of the v1 `converters` and `reserves` tables of a converter
+         * @details the progress is saved in the `migrations` table and returned (packed `migration_t`),
+         * one converter's tables can be cleared at a time
+         * @param currency - the currency code of the converter, the SCOPE of its v1 tables
+         * @param limit - maximum number of rows to erase in this call
+         */
+        [[eosio::action]]
+        void cleartables( const symbol_code currency, const uint64_t limit );
+
+        /**
+         * @brief returns a page of the converters' pricing state (packed `state_page`), without changing anything
+         * @details meant to be run without being included in a block (e.g. `compute_transaction`), the packed rows
+         * only hold the requested fields, unlike `get_table_rows` which expands every map of every row to JSON
+         * @param cursor - primary key (`currency.code().raw()`) to start from, 0 for the first page and `next` for the following ones
+         * @param limit - maximum number of converters to return, 1-500
+         * @param fields - any of `fee`, `reserves`, `supply` and `version`, all of them if empty
+         */
+        [[eosio::action]]
+        void getstate( const uint64_t cursor, const uint32_t limit, const vector<name> fields );
+
+        /**
+         * @brief returns the time-weighted average prices of a converter over the last `window` seconds (packed `twap_result`), without changing anything
+         * @details the prices are accumulated on the first change of the converter's balances or supply in every block, before
+         * the change, so trades can only move the average by holding a price for a while; the period starts at the latest
+         * observation at least `window` seconds old, observations are kept `ORACLE_PERIOD` seconds apart for `ORACLE_SIZE` periods
+         * @param currency - the currency code of the converter
+         * @param window - length of the averaged period in seconds
+         */
+        [[eosio::action]]
+        void gettwap( const symbol_code currency, const uint32_t window );
+
+        /**
+         * @brief settles up to `limit` queued conversions of a converter in batch mode at one clearing price, can be called by anyone
+         * @details the sales of either reserve are matched against each other at the clearing price and the pool only converts
+         * the excess, which moves the price as much as a single conversion of that excess would; every order pays the
+         * reserve --> reserve fee and is paid at the same price, orders below their minimum return are refunded in the
+         * reserve they sold. Returns are credited to the destination's and refunds to the trader's temporary balance
+         * (`accounts`) and withdrawn with `withdraw`. Each reserve balance changes once per batch and a single `batch_settlement` event
+         * replaces the orders' `conversion` events
+         * @param currency - the currency code of the converter
+         * @param limit - maximum number of queued conversions to settle, the oldest first
+         */
+        [[eosio::action]]
+        void settle( const symbol_code currency, const uint64_t limit );
+
         /**
          * @brief log event
          * @details inline action to record log events
@@ -314,6 +684,9 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
             indexed_by<"bycnvrt"_n, const_mem_fun <account_t, uint128_t, &account_t::by_cnvrt >>
         > accounts;
         typedef eosio::multi_index<"converters"_n, converters_t> converters;
+        typedef eosio::multi_index<"migrations"_n, migration_t> migrations;
+        typedef eosio::multi_index<"oracles"_n, oracle_t> oracles;
+        typedef eosio::multi_index<"orders"_n, order_t> orders;
 
         /*! \endcond */
 
@@ -324,22 +697,43 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         using setsettings_action = action_wrapper<"setsettings"_n, &BancorConverter::setsettings>;
         using updateowner_action = action_wrapper<"updateowner"_n, &BancorConverter::updateowner>;
         using updatefee_action = action_wrapper<"updatefee"_n, &BancorConverter::updatefee>;
+        using setevents_action = action_wrapper<"setevents"_n, &BancorConverter::setevents>;
         using setreserve_action = action_wrapper<"setreserve"_n, &BancorConverter::setreserve>;
         using delreserve_action = action_wrapper<"delreserve"_n, &BancorConverter::delreserve>;
         using withdraw_action = action_wrapper<"withdraw"_n, &BancorConverter::withdraw>;
         using fund_action = action_wrapper<"fund"_n, &BancorConverter::fund>;
+        using migrate_action = action_wrapper<"migrate"_n, &BancorConverter::migrate>;
+        using cleartables_action = action_wrapper<"cleartables"_n, &BancorConverter::cleartables>;
+        using getstate_action = action_wrapper<"getstate"_n, &BancorConverter::getstate>;
+        using gettwap_action = action_wrapper<"gettwap"_n, &BancorConverter::gettwap>;
+        using settle_action = action_wrapper<"settle"_n, &BancorConverter::settle>;
     private:
         void convert(name from, asset quantity, string memo, name code);
-        std::tuple<asset, double> calculate_return(const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol currency, const uint64_t fee, const name multi_token);
+        bool is_batched(const converters_t& converter);
+        void queue_conversion(const memo_structure& memo_object, const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol_code currency);
+        std::tuple<asset, double> calculate_return(const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol currency, const uint64_t fee, const asset supply);
         void apply_conversion(memo_structure memo_object, extended_asset from_token, extended_asset to_return, symbol converter_currency);
 
         BancorConverter::reserve get_reserve( const symbol_code currency, const symbol_code reserve );
         std::vector<BancorConverter::reserve> get_reserves( const symbol_code currency );
+        std::optional<reserve_record> find_reserve( const converters_t& converter, const symbol_code symbol );
+        std::vector<reserve_record> get_reserve_records( const converters_t& converter );
+        reserve_record& get_reserve_record( converters_t& converter, const symbol_code symbol );
+        void flatten_reserves( converters_t& converter );
 
         bool is_converter_active( const symbol_code converter );
 
-        void mod_reserve_balance(symbol converter_currency, asset value, int64_t pending_supply_change = 0);
+        void mod_reserve_balance(symbol converter_currency, asset value, int64_t supply_change = 0, bool closes_conversion = false);
+        void mod_supply(symbol converter_currency, int64_t supply_change);
+        bool is_price_data_due(converters_t& converter, symbol_code reserve, double price, bool closes_conversion);
+        void emplace_extensions(converters_t& converter);
+        void bump_version(converters_t& converter);
         void mod_account_balance(name sender, symbol_code converter_currency_code, asset quantity);
+
+        // oracle
+        void reset_oracle(const converters_t& converter, const name payer);
+        void observe_prices(const converters_t& converter);
+        vector<double> get_prices(const converters_t& converter, const vector<reserve_record>& reserves);
         void mod_balances(name sender, asset quantity, symbol_code converter_currency_code, name code);
 
         /**
@@ -352,10 +746,12 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
         void liquidate( const name sender, const asset quantity ); // quantity to decrease the supply by (in the smart token)
 
         asset get_supply(name contract, symbol_code sym);
+        asset get_supply(const converters_t& converter);
+        void verify_entry(name account, name currency_contract, symbol currency);
 
         double calculate_purchase_return(double balance, double deposit_amount, double supply, int64_t ratio);
         double calculate_sale_return(double balance, double sell_amount, double supply, int64_t ratio);
-        double quick_convert(double balance, double in, double toBalance);
+        double calculate_cross_reserve_return(double from_balance, double amount, double to_balance, int64_t from_ratio, int64_t to_ratio);
         double calculate_liquidate_return(double liquidation_amount, double supply, double reserve_balance, double total_ratio);
         double calculate_fund_cost(double funding_amount, double supply, double reserve_balance, double total_ratio);
 
@@ -368,6 +764,16 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
 
         constexpr static double DEFAULT_MAX_SUPPLY = 10000000000.0000;
         constexpr static uint8_t DEFAULT_TOKEN_PRECISION = 4;
+        constexpr static uint32_t MAX_STATE_PAGE = 500;
+        constexpr static uint32_t ORACLE_SIZE = 48;
+        constexpr static uint32_t ORACLE_PERIOD = 300; // seconds
+        constexpr static uint64_t MAX_ORDERS = 100;
+        constexpr static uint64_t MIN_ORDER_PPM = 10; // of the sold reserve's balance
+
+        // migrate
+        migration_t get_migration( const name task, const uint64_t scope );
+        void set_migration( const migration_t& progress );
+        uint64_t clear_table( const name table, const uint64_t scope, const uint64_t limit );
 
         // utils
         double asset_to_double( const asset quantity );
@@ -398,4 +804,16 @@ class [[eosio::contract]] BancorConverter : public contract { /*! \endcond */
             const uint64_t prev_fee,
             const uint64_t new_fee
         );
+        void emit_batch_settlement_event(
+            const symbol_code converter_currency_symbol,
+            const symbol_code reserve_a,
+            const symbol_code reserve_b,
+            const double price,
+            const double amount_a,
+            const double amount_b,
+            const double return_a,
+            const double return_b,
+            const uint64_t orders,
+            const uint64_t refunds
+        );
 }; /** @}*/
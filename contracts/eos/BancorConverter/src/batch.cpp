@@ -0,0 +1,108 @@
+[[eosio::action]]
+void BancorConverter::settle( const symbol_code currency, const uint64_t limit )
+{
+    check( limit > 0, "limit must be positive");
+
+    BancorConverter::converters _converters( get_self(), get_self().value );
+    BancorConverter::orders _orders( get_self(), currency.raw() );
+    const auto& converter = _converters.get( currency.raw(), "converter does not exist");
+    check( _orders.begin() != _orders.end(), "no queued conversions");
+
+    const vector<reserve_record> reserves = get_reserve_records( converter );
+    check( reserves.size() == 2, "batch conversions need a converter with two reserves");
+    const reserve_record& a = reserves[0];
+    const reserve_record& b = reserves[1];
+
+    // the oldest orders
+    vector<order_t> batch;
+    for ( auto itr = _orders.begin(); itr != _orders.end() && batch.size() < limit; ) {
+        batch.push_back( *itr );
+        itr = _orders.erase( itr );
+    }
+
+    // clears the orders that meet their minimum return at the price, without the ones that don't, until all of them do
+    vector<memo_structure> memos;
+    for ( const order_t& order : batch ) memos.push_back( parse_memo( order.memo ) );
+    vector<bool> refunded( batch.size(), false );
+    vector<asset> returns( batch.size() );
+    double price, amount_a, amount_b;
+    for ( bool changed = true; changed; ) {
+        amount_a = amount_b = 0;
+        for ( size_t i = 0; i < batch.size(); i++ ) {
+            if ( refunded[i] ) continue;
+            if ( batch[i].quantity.quantity.symbol.code() == a.symbol ) amount_a += asset_to_double( batch[i].quantity.quantity );
+            else amount_b += asset_to_double( batch[i].quantity.quantity );
+        }
+        price = curves::clearing_price( asset_to_double( a.balance.quantity ), a.weight, amount_a,
+                                        asset_to_double( b.balance.quantity ), b.weight, amount_b );
+
+        changed = false;
+        for ( size_t i = 0; i < batch.size(); i++ ) {
+            if ( refunded[i] ) continue;
+            const bool sells_a = batch[i].quantity.quantity.symbol.code() == a.symbol;
+            const double amount = asset_to_double( batch[i].quantity.quantity ) * ( sells_a ? price : 1 / price );
+            returns[i] = double_to_asset( amount - calculate_fee( amount, converter.fee, 2 ), sells_a ? b.balance.quantity.symbol : a.balance.quantity.symbol );
+            if ( !meets_min_return( returns[i], memos[i].min_return ) ) refunded[i] = changed = true;
+        }
+    }
+
+    // credit the returns to their destinations' and the refunds to their traders' temporary balances, withdrawn with
+    // `withdraw`, so an account that rejects transfers can't hold back the queue; the reserves keep what they sold less what they bought
+    asset delta_a = asset( 0, a.balance.quantity.symbol );
+    asset delta_b = asset( 0, b.balance.quantity.symbol );
+    double return_a = 0, return_b = 0;
+    uint64_t refunds = 0;
+    for ( size_t i = 0; i < batch.size(); i++ ) {
+        if ( refunded[i] ) {
+            mod_account_balance( name( memos[i].trader_account.c_str() ), currency, batch[i].quantity.quantity );
+            refunds++;
+            continue;
+        }
+
+        const bool sells_a = batch[i].quantity.quantity.symbol.code() == a.symbol;
+        if ( sells_a ) {
+            delta_a += batch[i].quantity.quantity;
+            delta_b -= returns[i];
+            return_b += asset_to_double( returns[i] );
+        }
+        else {
+            delta_b += batch[i].quantity.quantity;
+            delta_a -= returns[i];
+            return_a += asset_to_double( returns[i] );
+        }
+        mod_account_balance( name( memos[i].dest_account.c_str() ), currency, returns[i] );
+    }
+    mod_reserve_balance( converter.currency, delta_a );
+    mod_reserve_balance( converter.currency, delta_b, 0, true );
+
+    emit_batch_settlement_event( currency, a.symbol, b.symbol, price, amount_a, amount_b, return_a, return_b, batch.size() - refunds, refunds );
+}
+
+// converters in batch mode queue the reserve --> reserve conversions that end in them, see `settle`
+bool BancorConverter::is_batched( const converters_t& converter )
+{
+    const auto feature = converter.protocol_features.find( "batch"_n );
+    return feature != converter.protocol_features.end() && feature->second;
+}
+
+void BancorConverter::queue_conversion( const memo_structure& memo_object, const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol_code currency )
+{
+    // the checks of a final hop, so a queued order can only fail on its minimum return
+    const string trader = memo_object.trader_account;
+    check( !trader.empty() && is_account( name( trader.c_str() ) ), "invalid memo");
+    verify_entry( name( memo_object.dest_account.c_str() ), to_token.get_contract(), to_token.get_symbol() );
+
+    // the orders are queued from a transfer notification, which can only bill the contract's RAM: it is bounded by
+    // the queue length, and the minimum order size keeps dust from filling the queue
+    const BancorConverter::reserve reserve = get_reserve( currency, from_token.quantity.symbol.code() );
+    check( asset_to_double( from_token.quantity ) * PPM_RESOLUTION >= asset_to_double( reserve.balance ) * MIN_ORDER_PPM, "order below the minimum size");
+
+    BancorConverter::orders _orders( get_self(), currency.raw() );
+    if ( _orders.begin() != _orders.end() )
+        check( _orders.rbegin()->id - _orders.begin()->id + 1 < MAX_ORDERS, "order queue is full, settle it first");
+    _orders.emplace( get_self(), [&](auto& order) {
+        order.id = _orders.available_primary_key();
+        order.quantity = from_token;
+        order.memo = memo;
+    });
+}
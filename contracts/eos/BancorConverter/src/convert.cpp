@@ -32,7 +32,14 @@ void BancorConverter::convert(name from, asset quantity, string memo, name code)
         to_token = extended_symbol(r.balance.symbol, r.contract);
     }
 
-    auto [to_return, fee] = calculate_return(from_token, to_token, memo, converter.currency, converter.fee, settings.multi_token);
+    // converters in batch mode settle their final reserve --> reserve conversions together, see `settle`
+    if (is_batched(converter) && memo_object.path.size() == 2 && memo_object.affiliate_account.empty() &&
+        quantity.symbol != converter.currency && to_path_currency != converter.currency.code()) {
+        queue_conversion(memo_object, from_token, to_token, memo, converter_currency_code);
+        return;
+    }
+
+    auto [to_return, fee] = calculate_return(from_token, to_token, memo, converter.currency, converter.fee, get_supply(converter));
     apply_conversion(memo_object, from_token, extended_asset(to_return, to_token.get_contract()), converter.currency);
 
     emit_conversion_event(
@@ -41,17 +48,24 @@ void BancorConverter::convert(name from, asset quantity, string memo, name code)
         asset_to_double(to_return),
         fee
     );
+
+    // read back through a new table instance, `converter` still holds the balances from before the conversion
+    BancorConverter::converters _updated( get_self(), get_self().value );
+    vector<extended_asset> reserve_balances;
+    for (const reserve_record& reserve : get_reserve_records(_updated.get(converter_currency_code.raw())))
+        reserve_balances.push_back(reserve.balance);
+
+    set_action_return_value(conversion_result{ quantity, to_return, double_to_asset(fee, to_return.symbol), reserve_balances });
 }
 
-std::tuple<asset, double> BancorConverter::calculate_return(const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol currency, const uint64_t fee, const name multi_token) {
+std::tuple<asset, double> BancorConverter::calculate_return(const extended_asset from_token, const extended_symbol to_token, const string memo, const symbol currency, const uint64_t fee, const asset supply) {
     const symbol from_symbol = from_token.quantity.symbol;
     const symbol to_symbol = to_token.get_symbol();
 
     const bool incoming_smart_token = from_symbol == currency;
     const bool outgoing_smart_token = to_symbol == currency;
 
-    const asset supply = get_supply(multi_token, currency.code());
-    double current_smart_supply = supply.amount / pow(10, currency.precision());
+    const double current_smart_supply = supply.amount / pow(10, currency.precision());
 
     double current_from_balance, current_to_balance;
     BancorConverter::reserve input_reserve, to_reserve;
@@ -63,22 +77,16 @@ std::tuple<asset, double> BancorConverter::calculate_return(const extended_asset
         to_reserve = get_reserve(currency.code(), to_symbol.code());
         current_to_balance = asset_to_double(to_reserve.balance);
     }
-    const bool quick_conversion = !incoming_smart_token && !outgoing_smart_token && input_reserve.weight == to_reserve.weight;
-
-    double from_amount = asset_to_double(from_token.quantity);
+    const double from_amount = asset_to_double(from_token.quantity);
     double to_amount;
-    if (quick_conversion) { // Reserve --> Reserve
-        to_amount = quick_convert(current_from_balance, from_amount, current_to_balance);
+    if (!incoming_smart_token && !outgoing_smart_token) { // Reserve --> Reserve
+        to_amount = calculate_cross_reserve_return(current_from_balance, from_amount, current_to_balance, input_reserve.weight, to_reserve.weight);
     }
-    else {
-        if (!incoming_smart_token) { // Reserve --> Smart
-            to_amount = calculate_purchase_return(current_from_balance, from_amount, current_smart_supply, input_reserve.weight);
-            current_smart_supply += to_amount;
-            from_amount = to_amount;
-        }
-        if (!outgoing_smart_token) { // Smart --> Reserve
-            to_amount = calculate_sale_return(current_to_balance, from_amount, current_smart_supply, to_reserve.weight);
-        }
+    else if (!incoming_smart_token) { // Reserve --> Smart
+        to_amount = calculate_purchase_return(current_from_balance, from_amount, current_smart_supply, input_reserve.weight);
+    }
+    else { // Smart --> Reserve
+        to_amount = calculate_sale_return(current_to_balance, from_amount, current_smart_supply, to_reserve.weight);
     }
 
     const uint8_t magnitude = incoming_smart_token || outgoing_smart_token ? 1 : 2;
@@ -101,22 +109,36 @@ void BancorConverter::apply_conversion(memo_structure memo_object, extended_asse
     if (from_token.quantity.symbol == converter_currency) {
         Token::retire_action retire( from_token.contract, { get_self(), "active"_n });
         retire.send(from_token.quantity, "destroy on conversion");
-        mod_reserve_balance(converter_currency, -to_return.quantity, -from_token.quantity.amount);
+        mod_reserve_balance(converter_currency, -to_return.quantity, -from_token.quantity.amount, true);
     }
     else if (to_return.quantity.symbol == converter_currency) {
-        mod_reserve_balance(converter_currency, from_token.quantity, to_return.quantity.amount);
+        mod_reserve_balance(converter_currency, from_token.quantity, to_return.quantity.amount, true);
         Token::issue_action issue( to_return.contract, { get_self(), "active"_n });
         issue.send(get_self(), to_return.quantity, new_memo);
     }
     else {
         mod_reserve_balance(converter_currency, from_token.quantity);
-        mod_reserve_balance(converter_currency, -to_return.quantity);
+        mod_reserve_balance(converter_currency, -to_return.quantity, 0, true);
     }
 
     check(to_return.quantity.amount > 0, "below min return");
 
+    Token::transfer_action transfer( to_return.contract, { get_self(), "active"_n });
+
+    // final hop without an affiliate fee, the destination is paid directly instead of through the network
+    if (memo_object.path.empty() && memo_object.affiliate_account.empty()) {
+        const name dest_account = name(memo_object.dest_account.c_str());
+        const string trader = memo_object.trader_account;
+
+        check(!trader.empty() && is_account(name(trader.c_str())), "invalid memo");
+        verify_min_return(to_return.quantity, memo_object.min_return);
+        verify_entry(dest_account, to_return.contract, to_return.quantity.symbol);
+
+        transfer.send(get_self(), dest_account, to_return.quantity, memo_object.receiver_memo);
+        return;
+    }
+
     BancorConverter::settings _settings(get_self(), get_self().value);
     const auto settings = _settings.get();
-    Token::transfer_action transfer( to_return.contract, { get_self(), "active"_n });
     transfer.send(get_self(), settings.network, to_return.quantity, new_memo);
 }
\ No newline at end of file
@@ -18,17 +18,21 @@ void BancorConverter::create(const name owner, const symbol_code token_code, con
     check(initial_supply > 0, "must have a non-zero initial supply");
     check(initial_supply / maximum_supply <= MAX_INITIAL_MAXIMUM_SUPPLY_RATIO , "the ratio between initial and max supply is too big");
 
+    const asset initial_supply_asset = double_to_asset(initial_supply, token_symbol);
+    const asset maximum_supply_asset = double_to_asset(maximum_supply, token_symbol);
+
     // create converter
     _converters.emplace(owner, [&](auto& c) {
         c.currency = token_symbol;
         c.owner = owner;
         c.protocol_features["stake"_n] = false;
         c.fee = 0;
+        c.supply.emplace(initial_supply_asset);
+        c.events.emplace(event_settings{ "full"_n, 0, {} });
+        c.version.emplace(0);
+        c.reserves.emplace();
     });
 
-    const asset initial_supply_asset = double_to_asset(initial_supply, token_symbol);
-    const asset maximum_supply_asset = double_to_asset(maximum_supply, token_symbol);
-
     // create
     Token::create_action create( multi_token, { multi_token, "active"_n });
     create.send(get_self(), maximum_supply_asset);
@@ -55,12 +59,21 @@ void BancorConverter::activate( const symbol_code currency, const name protocol_
     require_auth(converter->owner);
 
     // available protocol features
-    const set<name> protocol_features = set<name>{"stake"_n};
+    const set<name> protocol_features = set<name>{"stake"_n, "batch"_n};
     check( protocol_features.find( protocol_feature ) != protocol_features.end(), "invalid protocol feature");
 
     // additional check for `stake` protocol feature
     if ( protocol_feature == "stake"_n ) check( is_account(settings.staking), "set staking account before enabling staking");
 
+    // additional check for `batch` protocol feature, the clearing price is between two reserves
+    if ( protocol_feature == "batch"_n && enabled ) check( get_reserve_records( *converter ).size() == 2, "batch conversions need a converter with two reserves");
+
+    // the queued orders can only be settled in batch mode, and only while the converter keeps its two reserves
+    if ( protocol_feature == "batch"_n && !enabled ) {
+        BancorConverter::orders _orders( get_self(), currency.raw() );
+        check( _orders.begin() == _orders.end(), "settle the queued conversions first");
+    }
+
     // update protocol feature
     _converters.modify(converter, same_payer, [&](auto& row) {
         check(row.protocol_features[protocol_feature] != enabled, "setting same value as before");
@@ -76,6 +89,11 @@ void BancorConverter::delconverter( const symbol_code converter_currency_code )
     check( itr != _converters.end(), "converter not found");
     check( itr->reserve_balances.size() == 0, "delete reserves first");
     check( itr->reserve_weights.size() == 0, "delete reserves first");
+    check( !itr->reserves.has_value() || itr->reserves.value().empty(), "delete reserves first");
 
     _converters.erase( itr );
+
+    BancorConverter::oracles _oracles( get_self(), get_self().value );
+    const auto oracle = _oracles.find( converter_currency_code.raw() );
+    if ( oracle != _oracles.end() ) _oracles.erase( oracle );
 }
@@ -68,3 +68,33 @@ void BancorConverter::emit_conversion_fee_update_event(
     BancorConverter::log_action log( get_self(), { get_self(), "active"_n });
     log.send("conversion_fee_update", "1.2", data);
 }
+
+void BancorConverter::emit_batch_settlement_event(
+    const symbol_code converter_currency_symbol,
+    const symbol_code reserve_a,
+    const symbol_code reserve_b,
+    const double price,
+    const double amount_a,
+    const double amount_b,
+    const double return_a,
+    const double return_b,
+    const uint64_t orders,
+    const uint64_t refunds
+) {
+    // data
+    map<string, string> data;
+    data["converter_currency_symbol"] = converter_currency_symbol.to_string();
+    data["reserve_a"] = reserve_a.to_string();
+    data["reserve_b"] = reserve_b.to_string();
+    data["price"] = to_string(price);
+    data["amount_a"] = to_string(amount_a);
+    data["amount_b"] = to_string(amount_b);
+    data["return_a"] = to_string(return_a);
+    data["return_b"] = to_string(return_b);
+    data["orders"] = to_string(orders);
+    data["refunds"] = to_string(refunds);
+
+    // send action
+    BancorConverter::log_action log( get_self(), { get_self(), "active"_n });
+    log.send("batch_settlement", "1.0", data);
+}
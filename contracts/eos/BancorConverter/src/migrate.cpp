@@ -1,87 +1,100 @@
 [[eosio::action]]
-void BancorConverter::migrate( const set<symbol_code> currencies )
+void BancorConverter::migrate( const name task, const uint64_t limit )
 {
     require_auth( get_self() );
+    check( limit > 0, "limit must be positive");
 
-    for ( const symbol_code symcode : currencies ) {
-        // TO-DO
-        // migrate TABLE `converters.v2` => `converters`
+    const set<name> tasks = set<name>{"supply"_n, "reserves"_n};
+    check( tasks.find( task ) != tasks.end(), "invalid migration task");
+
+    migration_t progress = get_migration( task, 0 );
+    check( !progress.done, "migration already complete");
+
+    BancorConverter::converters _converters( get_self(), get_self().value );
+    auto itr = _converters.lower_bound( progress.cursor );
+    for ( uint64_t i = 0; i < limit && itr != _converters.end(); i++, itr++ ) {
+        // mirror the smart token supply of converters created before it was cached in the row
+        if ( task == "supply"_n && !itr->supply.has_value() ) {
+            const asset supply = get_supply( *itr );
+            _converters.modify( itr, same_payer, [&](auto& row) {
+                row.supply.emplace( supply );
+            });
+        }
+        // move the reserves of converters created before they were kept flat out of the legacy maps
+        if ( task == "reserves"_n && !itr->reserves.has_value() ) {
+            _converters.modify( itr, same_payer, [&](auto& row) {
+                flatten_reserves( row );
+            });
+        }
+        progress.processed++;
     }
+
+    if ( itr == _converters.end() ) progress.done = true;
+    else progress.cursor = itr->primary_key();
+
+    set_migration( progress );
 }
 
 [[eosio::action]]
-void BancorConverter::cleartables( const set<symbol_code> currencies )
+void BancorConverter::cleartables( const symbol_code currency, const uint64_t limit )
 {
     require_auth( get_self() );
+    check( limit > 0, "limit must be positive");
 
-    for ( const symbol_code symcode : currencies ) {
-        // erase_converters_v1( symcode );
-        // erase_converters_v1_scoped( symcode );
-        // erase_reserves_v1( symcode );
-    }
+    // the v1 tables were scoped by the converter's currency, and their rows types are gone
+    // the current `converters` table shares their name under the contract's scope, which must never be cleared
+    check( currency.raw() != get_self().value, "cannot clear the current tables");
+    migration_t progress = get_migration( "cleartables"_n, currency.raw() );
+    check( !progress.done, "tables already cleared");
+
+    uint64_t erased = clear_table( "converters"_n, currency.raw(), limit );
+    erased += clear_table( "reserves"_n, currency.raw(), limit - erased );
+
+    progress.processed += erased;
+    progress.done = erased < limit;
+
+    set_migration( progress );
 }
 
-[[eosio::action]]
-void BancorConverter::synctables( const set<symbol_code> currencies )
+// returns the progress of `task`, a task that completed over another scope is started over
+BancorConverter::migration_t BancorConverter::get_migration( const name task, const uint64_t scope )
 {
-    require_auth( get_self() );
+    BancorConverter::migrations _migrations( get_self(), get_self().value );
+    const auto itr = _migrations.find( task.value );
 
-    for ( const symbol_code symcode : currencies ) {
-        synctable( symcode );
-    }
+    if ( itr == _migrations.end() || ( itr->done && itr->scope != scope ) )
+        return migration_t{ task, scope, 0, 0, false };
+
+    check( itr->scope == scope, "another scope of this task is in progress");
+    return *itr;
 }
 
-[[eosio::action]]
-void BancorConverter::synctable( const symbol_code currency )
+// stores the progress of a task, and returns it from the action
+void BancorConverter::set_migration( const migration_t& progress )
 {
-    require_auth( get_self() );
+    BancorConverter::migrations _migrations( get_self(), get_self().value );
+    const auto itr = _migrations.find( progress.task.value );
+
+    if ( itr == _migrations.end() ) _migrations.emplace( get_self(), [&](auto& row) { row = progress; });
+    else _migrations.modify( itr, same_payer, [&](auto& row) { row = progress; });
 
-    BancorConverter::converters_v2 _converters_v2(get_self(), get_self().value);
-    BancorConverter::converters _converters(get_self(), get_self().value);
-
-    auto itr_v2 = _converters_v2.find( currency.raw() );
-    auto itr = _converters.find( currency.raw() );
-
-    // clone previous table data
-    auto insert = [&]( auto & row ) {
-        row.currency = itr_v2->currency;
-        row.owner = itr_v2->owner;
-        row.fee = itr_v2->fee;
-        row.reserve_weights = itr_v2->reserve_weights;
-        row.reserve_balances = itr_v2->reserve_balances;
-        row.protocol_features = itr_v2->protocol_features;
-        row.metadata_json = itr_v2->metadata_json;
-    };
-
-    // create or modify
-    if ( itr == _converters.end() ) _converters.emplace( get_self(), insert );
-    else _converters.modify( itr, get_self(), insert );
+    set_action_return_value( progress );
 }
 
-// void BancorConverter::erase_converters_v1( const symbol_code symcode )
-// {
-//     BancorConverter::converters _converters( get_self(), get_self().value );
-//     auto itr = _converters.find( symcode.raw() );
-//     if ( itr != _converters.end() ) _converters.erase( itr );
-// }
-
-// void BancorConverter::erase_converters_v1_scoped( const symbol_code symcode )
-// {
-//     BancorConverter::converters _converters( get_self(), symcode.raw() );
-//     clear_table( _converters );
-// }
-
-// void BancorConverter::erase_reserves_v1( const symbol_code symcode )
-// {
-//     BancorConverter::reserves _reserves( get_self(), symcode.raw() );
-//     clear_table( _reserves );
-// }
-
-template <typename T>
-void BancorConverter::clear_table( T& table )
+// erases up to `limit` rows of a table through the database API, so that tables of removed row types can be erased too
+// returns the number of erased rows, less than `limit` once the table is empty; not for tables with secondary indices
+uint64_t BancorConverter::clear_table( const name table, const uint64_t scope, const uint64_t limit )
 {
-    auto itr = table.begin();
-    while ( itr != table.end() ) {
-        itr = table.erase( itr );
+    using namespace internal_use_do_not_use;
+
+    uint64_t erased = 0;
+    int32_t itr = db_lowerbound_i64( get_self().value, scope, table.value, 0 );
+    while ( erased < limit && itr >= 0 ) {
+        uint64_t primary_key;
+        const int32_t next = db_next_i64( itr, &primary_key );
+        db_remove_i64( itr );
+        itr = next;
+        erased++;
     }
-}
\ No newline at end of file
+    return erased;
+}
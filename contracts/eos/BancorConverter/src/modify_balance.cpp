@@ -25,19 +25,23 @@ void BancorConverter::mod_account_balance(name sender, symbol_code converter_cur
 
 void BancorConverter::mod_balances( name sender, asset quantity, symbol_code converter_currency_code, name code ) {
     BancorConverter::converters _converters( get_self(), get_self().value );
-    const auto converter = _converters.get( converter_currency_code.raw(), "converter not found");
-    check( converter.reserve_balances.count( quantity.symbol.code() ), "reserve balance not found");
-
-    const BancorConverter::reserve reserve = get_reserve( converter_currency_code, quantity.symbol.code() );
+    const auto& converter = _converters.get( converter_currency_code.raw(), "converter not found");
+    const std::optional<reserve_record> reserve = find_reserve( converter, quantity.symbol.code() );
+    check( reserve.has_value(), "reserve balance not found");
 
     if (quantity.amount > 0)
-        check(code == reserve.contract, "wrong origin contract for quantity");
+        check(code == reserve->balance.contract, "wrong origin contract for quantity");
     else {
-        Token::transfer_action transfer( reserve.contract, { get_self(), "active"_n });
+        Token::transfer_action transfer( reserve->balance.contract, { get_self(), "active"_n });
         transfer.send(get_self(), sender, -quantity, "withdrawal");
     }
 
-    if (is_converter_active(converter_currency_code))
+    // temporary balances, batch payouts included, stay withdrawable if the converter turns inactive
+    accounts acnts(get_self(), sender.value);
+    const auto index = acnts.get_index<"bycnvrt"_n >();
+    const bool has_balance = index.find(_by_cnvrt(quantity, converter_currency_code)) != index.end();
+
+    if (is_converter_active(converter_currency_code) || (quantity.amount < 0 && has_balance))
         mod_account_balance(sender, converter_currency_code, quantity);
     else {
         check(sender == converter.owner, "only converter owner may fund/withdraw prior to activation");
@@ -45,34 +49,111 @@ void BancorConverter::mod_balances( name sender, asset quantity, symbol_code con
     }
 }
 
-void BancorConverter::mod_reserve_balance(symbol converter_currency, asset value, int64_t pending_supply_change) {
-    // settings
-    BancorConverter::settings _settings( get_self(), get_self().value );
+void BancorConverter::mod_reserve_balance(symbol converter_currency, asset value, int64_t supply_change, bool closes_conversion) {
     BancorConverter::converters _converters( get_self(), get_self().value );
-    const name multi_token = _settings.get().multi_token;
     const symbol_code reserve_symcode = value.symbol.code();
 
-    // supply
-    const asset supply = get_supply(multi_token, converter_currency.code());
-    auto current_smart_supply = (supply.amount + pending_supply_change) / pow(10, converter_currency.precision());
-
     // converter
     const auto itr = _converters.find( converter_currency.code().raw() );
     check( itr != _converters.end(), "converter not found");
-    check( itr->reserve_balances.count( reserve_symcode ), "reserve balance not found");
-    check( itr->reserve_balances.at( reserve_symcode ).quantity.symbol == value.symbol, "incompatible symbols");
+    const std::optional<reserve_record> reserve = find_reserve( *itr, reserve_symcode );
+    check( reserve.has_value(), "reserve balance not found");
+    check( reserve->balance.quantity.symbol == value.symbol, "incompatible symbols");
+
+    observe_prices( *itr );
+
+    // supply, including the issue/retire sent along with this balance change
+    const asset supply = get_supply( *itr ) + asset( supply_change, converter_currency );
+    const double current_smart_supply = asset_to_double( supply );
 
     // modify reserve balance
+    extended_asset reserve_balance;
+    uint64_t reserve_weight;
+    bool emit_price_data;
     _converters.modify(itr, same_payer, [&](auto& row) {
-        row.reserve_balances[ reserve_symcode ].quantity += value;
-        check( row.reserve_balances[ reserve_symcode ].quantity.amount >= 0, "insufficient amount in reserve");
+        reserve_record& record = get_reserve_record( row, reserve_symcode );
+        record.balance.quantity += value;
+        check( record.balance.quantity.amount >= 0, "insufficient amount in reserve");
+        row.supply.emplace( supply );
+
+        reserve_balance = record.balance;
+        reserve_weight = record.weight;
+        const double price = asset_to_double( reserve_balance.quantity ) * PPM_RESOLUTION / ( current_smart_supply * reserve_weight );
+        emit_price_data = is_price_data_due( row, reserve_symcode, price, closes_conversion );
+        bump_version( row );
     });
 
     // log event
-    auto reserve = get_reserve( converter_currency.code(), reserve_symcode );
-    double reserve_balance = reserve.balance.amount / pow(10, reserve.balance.symbol.precision());
-    emit_price_data_event(converter_currency.code(), current_smart_supply,
-                        reserve.contract, reserve.balance.symbol.code(),
-                        reserve_balance, reserve.weight);
+    if (emit_price_data)
+        emit_price_data_event(converter_currency.code(), current_smart_supply,
+                            reserve_balance.contract, reserve_symcode,
+                            asset_to_double( reserve_balance.quantity ), reserve_weight);
+}
+
+// whether a reserve balance change is logged per the converter's `events` mode, `price` is the resulting smart token price in the reserve
+// in `conversion` mode, only the last reserve change of a conversion (`closes_conversion`) is logged
+// in `threshold` mode, the price of the logged event is kept as the reference for the next one
+bool BancorConverter::is_price_data_due(converters_t& converter, symbol_code reserve, double price, bool closes_conversion) {
+    if (!converter.events.has_value()) return true;
+
+    event_settings events = converter.events.value();
+    if (events.mode == "full"_n) return true;
+    if (events.mode == "conversion"_n) return closes_conversion;
+
+    const auto last = events.last_prices.find( reserve );
+    if (last != events.last_prices.end() && fabs( price - last->second ) * PPM_RESOLUTION < last->second * events.threshold)
+        return false;
+
+    events.last_prices[ reserve ] = price;
+    converter.events.emplace( events );
+    return true;
+}
+
+// emplaces the missing extensions up to `version` of a converter row being modified with their current values,
+// binary extensions are serialized in order so a later one can only be set once the ones before it are
+void BancorConverter::emplace_extensions(converters_t& converter) {
+    if (!converter.supply.has_value()) converter.supply.emplace( get_supply( converter ) );
+    if (!converter.events.has_value()) converter.events.emplace( event_settings{ "full"_n, 0, {} } );
+    if (!converter.version.has_value()) converter.version.emplace( 0 );
+}
 
+// bumps the state version of a converter row being modified
+void BancorConverter::bump_version(converters_t& converter) {
+    emplace_extensions( converter );
+    converter.version.emplace( converter.version.value() + 1 );
+}
+
+// moves the reserves of a converter row being modified out of the legacy maps
+void BancorConverter::flatten_reserves(converters_t& converter) {
+    if (converter.reserves.has_value()) return;
+
+    std::vector<reserve_record> records = get_reserve_records( converter );
+    emplace_extensions( converter );
+    converter.reserves.emplace( std::move( records ) );
+    converter.reserve_balances.clear();
+    converter.reserve_weights.clear();
+}
+
+// returns a reserve of a converter row being modified, to be changed in place
+BancorConverter::reserve_record& BancorConverter::get_reserve_record(converters_t& converter, const symbol_code symbol) {
+    flatten_reserves( converter );
+
+    std::vector<reserve_record>& records = converter.reserves.value();
+    const auto itr = std::find_if( records.begin(), records.end(), [&](const reserve_record& record) { return record.symbol == symbol; });
+    check( itr != records.end(), "reserve balance not found");
+    return *itr;
+}
+
+void BancorConverter::mod_supply(symbol converter_currency, int64_t supply_change) {
+    BancorConverter::converters _converters( get_self(), get_self().value );
+    const auto itr = _converters.find( converter_currency.code().raw() );
+    check( itr != _converters.end(), "converter not found");
+    observe_prices( *itr );
+
+    const asset supply = get_supply( *itr ) + asset( supply_change, converter_currency );
+    check( supply.amount >= 0, "insufficient supply");
+
+    _converters.modify(itr, same_payer, [&](auto& row) {
+        row.supply.emplace( supply );
+    });
 }
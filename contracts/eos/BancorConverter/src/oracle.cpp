@@ -0,0 +1,110 @@
+[[eosio::action]]
+void BancorConverter::gettwap( const symbol_code currency, const uint32_t window )
+{
+    check( window > 0, "window must be positive");
+
+    BancorConverter::converters _converters( get_self(), get_self().value );
+    BancorConverter::oracles _oracles( get_self(), get_self().value );
+    const auto& converter = _converters.get( currency.raw(), "converter does not exist");
+    const auto& oracle = _oracles.get( currency.raw(), "no price observations for this converter");
+
+    const vector<reserve_record> reserves = get_reserve_records( converter );
+    vector<symbol_code> symbols;
+    for ( const reserve_record& reserve : reserves ) symbols.push_back( reserve.symbol );
+    check( symbols == oracle.reserves, "no price observations for the current reserves");
+
+    // the current prices held since the last observed block, nothing changed them later in this one
+    const time_point now = current_time_point();
+    const time_point since = now - seconds( window );
+    const vector<double> prices = get_prices( converter, reserves );
+
+    twap_result result{ since, now, {} };
+    if ( oracle.last.timestamp <= since ) {
+        for ( size_t i = 0; i < symbols.size(); i++ ) result.prices[ symbols[i] ] = prices[i];
+    }
+    else {
+        // the latest observation at least `window` old
+        const price_observation* start = nullptr;
+        for ( const price_observation& observation : oracle.observations )
+            if ( observation.timestamp != time_point() && observation.timestamp <= since && ( !start || observation.timestamp > start->timestamp ) ) start = &observation;
+        check( start != nullptr, "not enough price history for this window");
+
+        const double elapsed = ( now - oracle.last.timestamp ).count() / 1e6;
+        const double period = ( now - start->timestamp ).count() / 1e6;
+        for ( size_t i = 0; i < symbols.size(); i++ ) {
+            const double cumulative = oracle.last.cumulatives[i] + prices[i] * elapsed;
+            result.prices[ symbols[i] ] = ( cumulative - start->cumulatives[i] ) / period;
+        }
+        result.start = start->timestamp;
+    }
+    set_action_return_value( result );
+}
+
+// starts the converter's observations over for its current reserves, erases them once it has none, only creates
+// the row with an actual `payer`; it is allocated at its full size, so the conversions observing prices never grow it
+void BancorConverter::reset_oracle( const converters_t& converter, const name payer )
+{
+    BancorConverter::oracles _oracles( get_self(), get_self().value );
+    const auto itr = _oracles.find( converter.currency.code().raw() );
+
+    vector<symbol_code> symbols;
+    for ( const reserve_record& reserve : get_reserve_records( converter ) ) symbols.push_back( reserve.symbol );
+    if ( symbols.empty() ) {
+        if ( itr != _oracles.end() ) _oracles.erase( itr );
+        return;
+    }
+
+    // unused slots keep a null timestamp
+    const price_observation first{ current_time_point(), vector<double>( symbols.size(), 0 ) };
+    vector<price_observation> observations( ORACLE_SIZE, price_observation{ time_point(), first.cumulatives } );
+    observations[0] = first;
+
+    const auto reset = [&](auto& oracle) {
+        oracle = oracle_t{ converter.currency.code(), symbols, first, 1 % ORACLE_SIZE, observations };
+    };
+    if ( itr != _oracles.end() ) _oracles.modify( itr, payer, reset );
+    else if ( payer != same_payer ) _oracles.emplace( payer, reset );
+}
+
+// accumulates the converter's prices on its first balance or supply change in a block, before the change,
+// the prices after the last change of the previously observed block held since that block
+// converters without observations for their current reserves (`reset_oracle`) are skipped
+void BancorConverter::observe_prices( const converters_t& converter )
+{
+    BancorConverter::oracles _oracles( get_self(), get_self().value );
+    const time_point now = current_time_point();
+    const auto itr = _oracles.find( converter.currency.code().raw() );
+    if ( itr == _oracles.end() || itr->last.timestamp == now ) return;
+
+    const vector<reserve_record> reserves = get_reserve_records( converter );
+    vector<symbol_code> symbols;
+    for ( const reserve_record& reserve : reserves ) symbols.push_back( reserve.symbol );
+    if ( itr->reserves != symbols ) return;
+
+    const vector<double> prices = get_prices( converter, reserves );
+    _oracles.modify( itr, same_payer, [&](auto& oracle) {
+        const double elapsed = ( now - oracle.last.timestamp ).count() / 1e6;
+        for ( size_t i = 0; i < prices.size(); i++ )
+            oracle.last.cumulatives[i] += prices[i] * elapsed;
+        oracle.last.timestamp = now;
+
+        const size_t latest = ( oracle.next + ORACLE_SIZE - 1 ) % ORACLE_SIZE;
+        if ( now - oracle.observations[ latest ].timestamp < seconds( ORACLE_PERIOD ) ) return;
+
+        oracle.observations[ oracle.next ] = oracle.last;
+        oracle.next = ( oracle.next + 1 ) % ORACLE_SIZE;
+    });
+}
+
+// returns the smart token price in every reserve, as logged by `price_data`, 0 for empty reserves
+vector<double> BancorConverter::get_prices( const converters_t& converter, const vector<reserve_record>& reserves )
+{
+    const double supply = asset_to_double( get_supply( converter ) );
+
+    vector<double> prices;
+    for ( const reserve_record& reserve : reserves ) {
+        const double balance = asset_to_double( reserve.balance.quantity );
+        prices.push_back( supply > 0 ? balance * PPM_RESOLUTION / ( supply * reserve.weight ) : 0 );
+    }
+    return prices;
+}
@@ -9,18 +9,26 @@ void BancorConverter::setreserve( const symbol_code converter_currency_code, con
     check( ratio > 0 && ratio <= PPM_RESOLUTION, "weight must be between 1 and " + std::to_string(PPM_RESOLUTION));
     check( is_account(contract), "token contract is not an account");
     check( currency.is_valid(), "invalid reserve symbol");
-    check( !converter->reserve_balances.count( currency.code() ), "reserve already exists");
+    check( !find_reserve( *converter, currency.code() ).has_value(), "reserve already exists");
+    check( !is_batched( *converter ), "cannot add reserves to a converter in batch mode");
+
+    BancorConverter::orders _orders( get_self(), converter_currency_code.raw() );
+    check( _orders.begin() == _orders.end(), "settle the queued conversions first");
 
     _converters.modify(converter, same_payer, [&](auto& row) {
-        row.reserve_balances[currency.code()] = {{0, currency}, contract};
-        row.reserve_weights[currency.code()] = ratio;
+        flatten_reserves( row );
+        std::vector<reserve_record>& reserves = row.reserves.value();
+        const auto position = std::find_if( reserves.begin(), reserves.end(), [&](const reserve_record& reserve) { return currency.code() < reserve.symbol; });
+        reserves.insert( position, reserve_record{ currency.code(), ratio, {{0, currency}, contract} } );
 
         double total_ratio = 0.0;
-        for ( const auto item : row.reserve_weights ) {
-            total_ratio += item.second;
+        for ( const reserve_record& reserve : reserves ) {
+            total_ratio += reserve.weight;
         }
         check(total_ratio <= PPM_RESOLUTION, "total ratio cannot exceed the maximum ratio");
+        bump_version(row);
     });
+    reset_oracle( *converter, converter->owner );
 }
 
 [[eosio::action]]
@@ -30,12 +38,18 @@ void BancorConverter::delreserve( const symbol_code converter, const symbol_code
     BancorConverter::converters _converters( get_self(), get_self().value );
     const auto itr = _converters.find( converter.raw() );
     check( itr != _converters.end(), "converter not found");
-    check( itr->reserve_balances.count( reserve ), "reserve balance not found");
+    check( find_reserve( *itr, reserve ).has_value(), "reserve balance not found");
+
+    BancorConverter::orders _orders( get_self(), converter.raw() );
+    check( _orders.begin() == _orders.end(), "settle the queued conversions first");
 
     _converters.modify(itr, same_payer, [&](auto& row) {
-        row.reserve_balances.erase( reserve );
-        row.reserve_weights.erase( reserve );
+        flatten_reserves( row );
+        std::vector<reserve_record>& reserves = row.reserves.value();
+        reserves.erase( std::find_if( reserves.begin(), reserves.end(), [&](const reserve_record& record) { return record.symbol == reserve; }) );
+        bump_version( row );
     });
+    reset_oracle( *itr, same_payer );
 }
 
 [[eosio::action]]
@@ -60,7 +74,7 @@ void BancorConverter::fund( const name sender, const asset quantity ) {
 
     // reserves
     std::vector<BancorConverter::reserve> reserves = BancorConverter::get_reserves( converter );
-    const asset supply = get_supply( multi_token, converter );
+    const asset supply = get_supply( *itr );
     double total_weight = 0.0;
 
     // calculate total weights
@@ -68,6 +82,9 @@ void BancorConverter::fund( const name sender, const asset quantity ) {
         total_weight += reserve.weight;
     }
 
+    // mirror the supply issued below
+    mod_supply( quantity.symbol, quantity.amount );
+
     // modify balance
     for ( const BancorConverter::reserve reserve : reserves ) {
         double amount = calculate_fund_cost( quantity.amount, supply.amount, reserve.balance.amount, total_weight );
@@ -100,22 +117,23 @@ double BancorConverter::calculate_fund_cost(double funding_amount, double supply
     if (funding_amount == 0)
         return 0;
 
-    if (total_ratio == MAX_RATIO)
-        return reserve_balance * funding_amount / supply;
-
-    return reserve_balance * (pow(((supply + funding_amount) / supply), (MAX_RATIO / total_ratio)) - 1.0);
+    return curves::fund_cost(supply, reserve_balance, funding_amount, total_ratio);
 }
 
 void BancorConverter::liquidate( const name sender, const asset quantity) {
     BancorConverter::settings _settings(get_self(), get_self().value);
+    BancorConverter::converters _converters(get_self(), get_self().value);
 
     const name multi_token = _settings.get().multi_token;
     check( get_first_receiver() == multi_token, "bad origin for this transfer");
 
     const symbol_code converter = quantity.symbol.code();
-    const asset supply = get_supply( multi_token, converter );
+    const asset supply = get_supply( _converters.get( converter.raw(), "converter does not exist") );
     std::vector<BancorConverter::reserve> reserves = BancorConverter::get_reserves( converter );
 
+    // mirror the supply retired below
+    mod_supply( quantity.symbol, -quantity.amount );
+
     double total_weight = 0.0;
     for (const BancorConverter::reserve reserve : reserves ) {
         total_weight += reserve.weight;
@@ -149,8 +167,5 @@ double BancorConverter::calculate_liquidate_return( const double liquidation_amo
     if (liquidation_amount == supply)
         return reserve_balance;
 
-    if (total_weight == PPM_RESOLUTION)
-        return liquidation_amount * reserve_balance / supply;
-
-    return reserve_balance * (1.0 - pow(((supply - liquidation_amount) / supply), (PPM_RESOLUTION / total_weight)));
+    return curves::liquidate_return(supply, reserve_balance, liquidation_amount, total_weight);
 }
\ No newline at end of file
@@ -55,7 +55,28 @@ void BancorConverter::updatefee(symbol_code currency, uint64_t fee) {
         uint64_t prevFee = converter.fee;
         _converters.modify(converter, same_payer, [&](auto& c) {
             c.fee = fee;
+            bump_version(c);
         });
         emit_conversion_fee_update_event(currency, prevFee, fee);
     }
-}
\ No newline at end of file
+}
+
+[[eosio::action]]
+void BancorConverter::setevents(symbol_code currency, name mode, uint64_t threshold) {
+    BancorConverter::converters _converters(get_self(), get_self().value);
+    const auto& converter = _converters.get(currency.raw(), "converter does not exist");
+
+    require_auth(converter.owner);
+
+    const set<name> modes = set<name>{"full"_n, "conversion"_n, "threshold"_n};
+    check(modes.find(mode) != modes.end(), "invalid events mode");
+    if (mode == "threshold"_n)
+        check(threshold > 0 && threshold <= PPM_RESOLUTION, "threshold must be between 1 and 1000000");
+    else
+        check(threshold == 0, "threshold is only used in threshold mode");
+
+    _converters.modify(converter, same_payer, [&](auto& c) {
+        if (!c.supply.has_value()) c.supply.emplace(get_supply(c)); // extensions can't be skipped
+        c.events.emplace(event_settings{ mode, threshold, {} });
+    });
+}
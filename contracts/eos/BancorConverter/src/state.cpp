@@ -0,0 +1,27 @@
+[[eosio::action]]
+void BancorConverter::getstate( const uint64_t cursor, const uint32_t limit, const vector<name> fields )
+{
+    check( limit > 0 && limit <= MAX_STATE_PAGE, "limit must be between 1 and " + std::to_string(MAX_STATE_PAGE));
+
+    const set<name> available = set<name>{"fee"_n, "reserves"_n, "supply"_n, "version"_n};
+    for ( const name field : fields )
+        check( available.find( field ) != available.end(), "invalid state field");
+    const auto requested = [&]( const name field ) {
+        return fields.empty() || std::find( fields.begin(), fields.end(), field ) != fields.end();
+    };
+
+    BancorConverter::converters _converters( get_self(), get_self().value );
+    state_page page{ {}, 0 };
+    auto itr = _converters.lower_bound( cursor );
+    for ( ; itr != _converters.end() && page.converters.size() < limit; itr++ ) {
+        converter_state state{ itr->currency };
+        if ( requested( "fee"_n ) ) state.fee = itr->fee;
+        if ( requested( "reserves"_n ) ) state.reserves = get_reserve_records( *itr );
+        if ( requested( "supply"_n ) ) state.supply = get_supply( *itr );
+        if ( requested( "version"_n ) ) state.version = itr->version.has_value() ? itr->version.value() : 0;
+        page.converters.push_back( state );
+    }
+    if ( itr != _converters.end() ) page.next = itr->primary_key();
+
+    set_action_return_value( page );
+}
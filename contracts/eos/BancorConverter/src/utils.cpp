@@ -11,12 +11,11 @@ bool BancorConverter::is_converter_active( const symbol_code converter) {
 BancorConverter::reserve BancorConverter::get_reserve( const symbol_code currency, const symbol_code reserve )
 {
     BancorConverter::converters _converter( get_self(), get_self().value );
-    auto row = _converter.get( currency.raw(), "BancorConverter: currency symbol does not exist");
-    check(row.reserve_balances.count(reserve), "BancorConverter: reserve balance symbol does not exist");
-    check(row.reserve_weights.count(reserve), "BancorConverter: reserve weights symbol does not exist");
+    const auto& row = _converter.get( currency.raw(), "BancorConverter: currency symbol does not exist");
+    const std::optional<reserve_record> record = find_reserve( row, reserve );
+    check(record.has_value(), "BancorConverter: reserve balance symbol does not exist");
 
-    const extended_asset balance = row.reserve_balances.at(reserve);
-    return BancorConverter::reserve{ balance.contract, row.reserve_weights.at(reserve), balance.quantity };
+    return BancorConverter::reserve{ record->balance.contract, record->weight, record->balance.quantity };
 }
 
 std::vector<BancorConverter::reserve> BancorConverter::get_reserves( const symbol_code currency )
@@ -24,13 +23,42 @@ std::vector<BancorConverter::reserve> BancorConverter::get_reserves( const symbo
     BancorConverter::converters _converter( get_self(), get_self().value );
     std::vector<BancorConverter::reserve> reserves;
 
-    auto row = _converter.get( currency.raw(), "BancorConverter: currency symbol does not exist");
-    for ( const auto itr : row.reserve_balances ) {
-        reserves.push_back( BancorConverter::get_reserve( currency, itr.first ) );
+    const auto& row = _converter.get( currency.raw(), "BancorConverter: currency symbol does not exist");
+    for ( const reserve_record& record : get_reserve_records( row ) ) {
+        reserves.push_back( BancorConverter::reserve{ record.balance.contract, record.weight, record.balance.quantity } );
     }
     return reserves;
 }
 
+// looks a reserve up with a linear scan of the converter's flat reserves, converters that weren't migrated yet still keep it in the legacy maps
+std::optional<BancorConverter::reserve_record> BancorConverter::find_reserve( const converters_t& converter, const symbol_code symbol )
+{
+    if ( converter.reserves.has_value() ) {
+        for ( const reserve_record& record : converter.reserves.value() )
+            if ( record.symbol == symbol ) return record;
+        return std::nullopt;
+    }
+
+    const auto balance = converter.reserve_balances.find( symbol );
+    const auto weight = converter.reserve_weights.find( symbol );
+    if ( balance == converter.reserve_balances.end() || weight == converter.reserve_weights.end() ) return std::nullopt;
+    return reserve_record{ symbol, weight->second, balance->second };
+}
+
+// returns the reserves of a converter, sorted by symbol
+std::vector<BancorConverter::reserve_record> BancorConverter::get_reserve_records( const converters_t& converter )
+{
+    if ( converter.reserves.has_value() ) return converter.reserves.value();
+
+    std::vector<reserve_record> records;
+    for ( const auto& balance : converter.reserve_balances ) {
+        const auto weight = converter.reserve_weights.find( balance.first );
+        check( weight != converter.reserve_weights.end(), "BancorConverter: reserve weights symbol does not exist");
+        records.push_back( reserve_record{ balance.first, weight->second, balance.second } );
+    }
+    return records;
+}
+
 // returns a token supply
 asset BancorConverter::get_supply(name contract, symbol_code sym) {
     Token::stats statstable(contract, sym.raw());
@@ -38,34 +66,41 @@ asset BancorConverter::get_supply(name contract, symbol_code sym) {
     return st.supply;
 }
 
+// asserts if the supplied account doesn't have an entry for a given token
+void BancorConverter::verify_entry(name account, name currency_contract, symbol currency) {
+    check(is_account(account), "destination is not an account");
+    Token::accounts accountstable(currency_contract, account.value);
+    auto ac = accountstable.find(currency.code().raw());
+    check(ac != accountstable.end(), "must have entry for token (claim token first)");
+}
+
+// returns the smart token supply mirrored in the converter
+asset BancorConverter::get_supply(const converters_t& converter) {
+    if (converter.supply.has_value())
+        return converter.supply.value();
+
+    // converters created before the supply was mirrored, the multi-token is only read until their next update
+    BancorConverter::settings _settings(get_self(), get_self().value);
+    return get_supply(_settings.get().multi_token, converter.currency.code());
+}
+
 // given a token supply, reserve balance, ratio and a input amount (in the reserve token),
 // calculates the return for a given conversion (in the smart token)
 double BancorConverter::calculate_purchase_return(double balance, double deposit_amount, double supply, int64_t ratio) {
-    double R(supply);
-    double C(balance);
-    double F(ratio / MAX_RATIO);
-    double T(deposit_amount);
-    double ONE(1.0);
-
-    double E = -R * (ONE - pow(ONE + T / C, F));
-    return E;
+    return curves::purchase_return(supply, balance, deposit_amount, ratio);
 }
 
 // given a token supply, reserve balance, ratio and a input amount (in the smart token),
 // calculates the return for a given conversion (in the reserve token)
 double BancorConverter::calculate_sale_return(double balance, double sell_amount, double supply, int64_t ratio) {
-    double R(supply);
-    double C(balance);
-    double F(MAX_RATIO / ratio);
-    double E(sell_amount);
-    double ONE(1.0);
-
-    double T = C * (ONE - pow(ONE - E/R, F));
-    return T;
+    return curves::sale_return(supply, balance, sell_amount, ratio);
 }
 
-double BancorConverter::quick_convert(double balance, double in, double toBalance) {
-    return in / (balance + in) * toBalance;
+// given both reserve balances and weights and a input amount (in the 'from' reserve token),
+// calculates the return for a conversion between the reserves (in the 'to' reserve token)
+// equivalent to a purchase followed by a sale, without the intermediate smart token amount
+double BancorConverter::calculate_cross_reserve_return(double from_balance, double amount, double to_balance, int64_t from_ratio, int64_t to_ratio) {
+    return curves::cross_reserve_return(from_balance, amount, to_balance, from_ratio, to_ratio);
 }
 
 double BancorConverter::asset_to_double( const asset quantity ) {
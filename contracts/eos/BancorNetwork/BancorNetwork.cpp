@@ -6,6 +6,7 @@
 
 #include "../Common/common.hpp"
 #include "../Token/Token.hpp"
+#include "../BancorConverter/BancorConverter.hpp"
 #include "BancorNetwork.hpp"
 
 ACTION BancorNetwork::setmaxfee(uint64_t max_affiliate_fee) {
@@ -42,6 +43,45 @@ ACTION BancorNetwork::setnettoken(name network_token) {
         });
 }
 
+ACTION BancorNetwork::regconverter(name account, symbol_code smart_token) {
+    require_auth(get_self());
+
+    converters converters_table(get_self(), get_self().value);
+    auto cnvrt = converters_table.find(account.value);
+    check(is_account(account), "converter account doesn't exist");
+    check(smart_token.is_valid(), "invalid smart token symbol");
+
+    if (cnvrt == converters_table.end())
+        converters_table.emplace(get_self(), [&](auto& c) {
+            c.account = account;
+            c.smart_tokens = { smart_token };
+        });
+    else {
+        check(find(cnvrt->smart_tokens.begin(), cnvrt->smart_tokens.end(), smart_token) == cnvrt->smart_tokens.end(), "smart token already registered");
+        converters_table.modify(cnvrt, same_payer, [&](auto& c) {
+            c.smart_tokens.push_back(smart_token);
+        });
+    }
+}
+
+ACTION BancorNetwork::delconverter(name account, symbol_code smart_token) {
+    require_auth(get_self());
+
+    converters converters_table(get_self(), get_self().value);
+    auto cnvrt = converters_table.find(account.value);
+    check(cnvrt != converters_table.end(), "converter not registered");
+
+    auto token = find(cnvrt->smart_tokens.begin(), cnvrt->smart_tokens.end(), smart_token);
+    check(token != cnvrt->smart_tokens.end(), "smart token not registered");
+
+    if (cnvrt->smart_tokens.size() == 1)
+        converters_table.erase(cnvrt);
+    else
+        converters_table.modify(cnvrt, same_payer, [&](auto& c) {
+            c.smart_tokens.erase(c.smart_tokens.begin() + (token - cnvrt->smart_tokens.begin()));
+        });
+}
+
 void BancorNetwork::on_transfer(name from, name to, asset quantity, string memo) {
     // avoid unstaking and system contract ops mishaps
     if (from == get_self() || from == "eosio.ram"_n || from == "eosio.stake"_n || from == "eosio.rex"_n)
@@ -72,6 +112,7 @@ void BancorNetwork::on_transfer(name from, name to, asset quantity, string memo)
         check(path_size >= 2 && !(path_size % 2), "bad path format");
 
         if (memo_object.trader_account.empty()) { // about to enter the first conversion in the path
+            verify_path(memo_object);
             memo_object.trader_account = from.to_string();
             memo = build_memo(memo_object);
         } else
@@ -80,7 +121,11 @@ void BancorNetwork::on_transfer(name from, name to, asset quantity, string memo)
     if (new_quantity.amount != quantity.amount) // if affiliate fee was deducted from was from quantity
         memo = build_memo(memo_object);
 
-    verify_entry(to, get_first_receiver(), quantity.symbol);
+    // registered converters were already validated when the path entered the network
+    converters converters_table(get_self(), get_self().value);
+    if (converters_table.find(to.value) == converters_table.end())
+        verify_entry(to, get_first_receiver(), quantity.symbol);
+
     action(
         permission_level{ get_self(), "active"_n },
         get_first_receiver(), "transfer"_n,
@@ -121,14 +166,45 @@ tuple<asset, memo_structure> BancorNetwork::pay_affiliate(name from, asset quant
     return make_tuple(quantity, memo);
 }
 
-// asserts if a conversion resulted in an amount lower than the minimum amount defined by the caller
-void BancorNetwork::verify_min_return(asset quantity, string min_return) {
-	float ret = stof(min_return.c_str());
-    uint64_t ret_amount = ret * pow(10, quantity.symbol.precision());
-    if (ret_amount)
-        check(quantity.amount >= ret_amount, "below min return");
-    else
-        check(quantity.amount > 0, "return must be above zero");
+// asserts if any hop of a conversion path can't be entered, so that a bad path fails before its first conversion
+void BancorNetwork::verify_path(const memo_structure& memo) {
+    converters converters_table(get_self(), get_self().value);
+
+    for (size_t i = 0; i < memo.converters.size(); i++) {
+        const converter& hop = memo.converters[i];
+        const symbol_code to = symbol_code(memo.path[i * 2 + 1]);
+        check(to.is_valid(), "invalid symbol in path");
+
+        // unregistered converter accounts are still checked hop by hop, when the tokens are sent to them,
+        // while any pool of a registered account is checked against its own tables, so pools created after registration stay reachable
+        if (converters_table.find(hop.account.value) == converters_table.end())
+            continue;
+
+        check(converts_to(hop, to), "converter cannot convert to path symbol");
+    }
+    check(is_account(name(memo.dest_account.c_str())), "destination is not an account");
+}
+
+// whether a registered converter holds `symbol` as its smart token or one of its reserves,
+// multi-converter hops name their smart token (`account:SYM`), legacy converter hops don't
+bool BancorNetwork::converts_to(const converter& hop, symbol_code symbol) {
+    if (!hop.sym.empty()) {
+        BancorConverter::converters converters_table(hop.account, hop.account.value);
+        const auto& row = converters_table.get(symbol_code(hop.sym).raw(), "converter does not exist");
+        if (row.currency.code() == symbol)
+            return true;
+        if (row.reserves.has_value())
+            return any_of(row.reserves.value().begin(), row.reserves.value().end(), [&](const auto& reserve) { return reserve.symbol == symbol; });
+        return row.reserve_balances.count(symbol) > 0;
+    }
+
+    legacy_settings settings_table(hop.account, hop.account.value);
+    const auto& st = settings_table.get("settings"_n.value, "converter settings do not exist");
+    if (st.smart_currency.symbol.code() == symbol)
+        return true;
+
+    legacy_reserves reserves_table(hop.account, hop.account.value);
+    return reserves_table.find(symbol.raw()) != reserves_table.end();
 }
 
 // asserts if the supplied account doesn't have an entry for a given token
@@ -39,15 +39,14 @@ using namespace std;
  * - the account that was paid the affiliate fee
  * - the amount of that was paid as affiliate fee
  */
-#define EMIT_AFFILIATE_FEE_EVENT(trader, from_contract, fee_account, to_amount, fee_amount){ \
-    START_EVENT("affiliate", "1.0") \
-    EVENTKV("trader", trader) \
-    EVENTKV("from_contract", from_contract) \
-    EVENTKV("affiliate_account", fee_account) \
-    EVENTKV("return", to_amount) \
-    EVENTKVL("affiliate_fee", fee_amount) \
-    END_EVENT() \
-}
+#define EMIT_AFFILIATE_FEE_EVENT(trader, from_contract, fee_account, to_amount, fee_amount) \
+    emit_event("affiliate", "1.0", \
+        event_kv("trader", trader), \
+        event_kv("from_contract", from_contract), \
+        event_kv("affiliate_account", fee_account), \
+        event_kv("return", to_amount), \
+        event_kv("affiliate_fee", fee_amount) \
+    )
 
 /*! \cond DOCS_EXCLUDE */
 CONTRACT BancorNetwork : public eosio::contract { /*! \endcond */
@@ -77,6 +76,31 @@ CONTRACT BancorNetwork : public eosio::contract { /*! \endcond */
 
             }; /** @}*/
 
+        /**
+         * @defgroup Network_Converters_Table Converters Table
+         * @brief This table stores the converters known to the network
+         * @details conversion paths are validated against this table once, when they enter the network;
+         * hops into registered converters then skip the per-hop destination account and token entry checks
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            TABLE converter_t { /*! \endcond */
+
+                /**
+                 * @brief converter account - PRIMARY KEY
+                 */
+                name account;
+
+                /**
+                 * @brief smart tokens of the converters held by the account
+                 */
+                vector<symbol_code> smart_tokens;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return account.value; }
+                /*! \endcond */
+
+            }; /** @}*/
+
         /**
          * @brief set the maximum affliate fee for all chained BNT conversions
          * @param max_affiliate_fee - what network owner determines to be the maximum
@@ -89,6 +113,20 @@ CONTRACT BancorNetwork : public eosio::contract { /*! \endcond */
          */
         ACTION setnettoken(name network_token);
 
+        /**
+         * @brief registers a converter smart token held by a converter account
+         * @param account - converter account
+         * @param smart_token - smart token symbol of the converter
+         */
+        ACTION regconverter(name account, symbol_code smart_token);
+
+        /**
+         * @brief removes a converter smart token from the registry, the account is removed along with its last smart token
+         * @param account - converter account
+         * @param smart_token - smart token symbol of the converter
+         */
+        ACTION delconverter(name account, symbol_code smart_token);
+
         /**
          * @brief transfer intercepts
          * @details conversion will fail if the amount returned is lower "minreturn" element in the `memo`
@@ -99,10 +137,26 @@ CONTRACT BancorNetwork : public eosio::contract { /*! \endcond */
     private:
         using transfer_action = action_wrapper<name("transfer"), &BancorNetwork::on_transfer>;
         typedef eosio::multi_index<"settings"_n, settings_t> settings;
+        typedef eosio::multi_index<"converters"_n, converter_t> converters;
+
+        // the leading fields of the legacy converter's settings and reserves rows, read to validate paths through it
+        struct legacy_settings_t {
+            name  smart_contract;
+            asset smart_currency;
+            uint64_t primary_key() const { return "settings"_n.value; }
+        };
+        struct legacy_reserve_t {
+            name  contract;
+            asset currency;
+            uint64_t primary_key() const { return currency.symbol.code().raw(); }
+        };
+        typedef eosio::multi_index<"settings"_n, legacy_settings_t> legacy_settings;
+        typedef eosio::multi_index<"reserves"_n, legacy_reserve_t> legacy_reserves;
 
         tuple<asset, memo_structure> pay_affiliate(name from, asset quantity, uint64_t max_fee, memo_structure memo);
 
-        void verify_min_return(asset quantity, string min_return);
+        void verify_path(const memo_structure& memo);
+        bool converts_to(const converter& hop, symbol_code symbol);
         void verify_entry(name account, name currency_contract, symbol currency);
 
 }; /** @}*/
@@ -24,6 +24,7 @@ ACTION BancorX::init(name x_token_name, uint64_t min_reporters, uint64_t min_lim
 
     uint64_t current_time = current_time_point().sec_since_epoch();
 
+    // the limits all blockchains share until `addchain` adds the first one to the `buckets` table
     settings_table.set(settings_t{
         x_token_name,
         false,
@@ -102,29 +103,47 @@ ACTION BancorX::rmreporter(name reporter) {
     reporters_table.erase(it);
 }
 
-ACTION BancorX::reporttx(name reporter, string blockchain, uint64_t tx_id, uint64_t x_transfer_id, name target, asset quantity, string memo, string data) {
-    // checks that the reporter signed on the tx
-    require_auth(reporter);
+ACTION BancorX::addchain(string blockchain) {
+    require_auth(get_self());
 
-    check(memo.size() <= 256, "memo has more than 256 bytes");
+    settings settings_table(get_self(), get_self().value);
+    const auto st = settings_table.get();
+
+    limiter issue_limiter(get_self(), "issue"_n, st.max_issue_limit, st.limit_inc);
+    limiter destroy_limiter(get_self(), "destroy"_n, st.max_destroy_limit, st.limit_inc);
+    check(!issue_limiter.has(blockchain), "blockchain already supported");
+
+    // the buckets start from the shared limits, so upgrading to per blockchain limits doesn't refill them
+    const uint64_t current_time = current_time_point().sec_since_epoch();
+    issue_limiter.add(blockchain, get_self(), issue_limiter.refill(st.prev_issue_limit, st.prev_issue_time, current_time));
+    destroy_limiter.add(blockchain, get_self(), destroy_limiter.refill(st.prev_destroy_limit, st.prev_destroy_time, current_time));
+}
+
+ACTION BancorX::rmchain(string blockchain) {
+    require_auth(get_self());
 
     settings settings_table(get_self(), get_self().value);
-    auto st = settings_table.get();
+    const auto st = settings_table.get();
 
-    check(st.rpt_enabled, "reporting is disabled");
+    limiter issue_limiter(get_self(), "issue"_n, st.max_issue_limit, st.limit_inc);
+    limiter destroy_limiter(get_self(), "destroy"_n, st.max_destroy_limit, st.limit_inc);
+    check(issue_limiter.has(blockchain), "unsupported blockchain");
 
-    uint64_t prev_issue_limit = st.prev_issue_limit;
-    uint64_t prev_issue_time = st.prev_issue_time;
-    uint64_t limit_inc = st.limit_inc;
+    issue_limiter.remove(blockchain);
+    destroy_limiter.remove(blockchain);
+    check(!issue_limiter.empty(), "cannot remove the last supported blockchain");
+}
 
-    uint64_t timestamp = current_time_point().sec_since_epoch();
+ACTION BancorX::reporttx(name reporter, string blockchain, uint64_t tx_id, uint64_t x_transfer_id, name target, asset quantity, string memo, string data) {
+    // checks that the reporter signed on the tx
+    require_auth(reporter);
 
-    uint64_t current_delta = 0;
-    if (timestamp > prev_issue_time)
-        current_delta = timestamp - prev_issue_time;
+    check(memo.size() <= 256, "memo has more than 256 bytes");
 
-    uint64_t current_limit = std::min(prev_issue_limit + limit_inc * current_delta, st.max_issue_limit);
+    settings settings_table(get_self(), get_self().value);
+    const auto st = settings_table.get();
 
+    check(st.rpt_enabled, "reporting is disabled");
     check(quantity.amount >= st.min_limit, "below min limit");
 
     // checks that the signer is known reporter
@@ -139,7 +158,8 @@ ACTION BancorX::reporttx(name reporter, string blockchain, uint64_t tx_id, uint6
 
     // first reporter
     if (transaction == transfers_table.end()) {
-        check(quantity.amount <= current_limit, "above max limit");
+        consume_limit("issue"_n, blockchain, quantity.amount);
+
         transfers_table.emplace(get_self(), [&](auto& s) {
             s.tx_id           = tx_id;
             s.x_transfer_id   = x_transfer_id;
@@ -149,12 +169,9 @@ ACTION BancorX::reporttx(name reporter, string blockchain, uint64_t tx_id, uint6
             s.memo            = memo;
             s.data            = data;
             s.reporters.push_back(reporter);
+            s.timestamp.emplace(current_time_point().sec_since_epoch());
         });
 
-        st.prev_issue_limit = current_limit - quantity.amount;
-        st.prev_issue_time  = timestamp;
-        settings_table.set(st, get_self());
-
         EMIT_TX_REPORT_EVENT(reporter, blockchain, tx_id, target, quantity, x_transfer_id, memo);
     }
     else {
@@ -210,6 +227,8 @@ ACTION BancorX::reporttx(name reporter, string blockchain, uint64_t tx_id, uint6
 
         EMIT_X_TRANSFER_COMPLETE_EVENT(target, x_transfer_id);
     }
+
+    collect_garbage();
 }
 
 ACTION BancorX::clearamount(uint64_t x_transfer_id) {
@@ -244,24 +263,12 @@ void BancorX::on_transfer(name from, name to, asset quantity, string memo) {
 
 void BancorX::xtransfer(string blockchain, name from, string target, asset quantity, std::string x_transfer_id) {
     settings settings_table(get_self(), get_self().value);
-    auto st = settings_table.get();
+    const auto st = settings_table.get();
 
     check(st.xt_enabled, "x transfers are disabled");
-
-    uint64_t prev_destroy_limit = st.prev_destroy_limit;
-    uint64_t prev_destroy_time = st.prev_destroy_time;
-    uint64_t limit_inc = st.limit_inc;
-
-    uint64_t timestamp = current_time_point().sec_since_epoch();
-
-    uint64_t current_delta = 0;
-    if (timestamp > prev_destroy_time)
-        current_delta = timestamp - prev_destroy_time;
-
-    uint64_t current_limit = std::min(prev_destroy_limit + limit_inc * current_delta, st.max_destroy_limit);
-
     check(quantity.amount >= st.min_limit, "below min limit");
-    check(quantity.amount <= current_limit, "above max limit");
+
+    consume_limit("destroy"_n, blockchain, quantity.amount);
 
     action(
         permission_level{ get_self(), "active"_n },
@@ -269,10 +276,69 @@ void BancorX::xtransfer(string blockchain, name from, string target, asset quant
         std::make_tuple(quantity,std::string("destroy on x transfer"))
     ).send();
 
-    st.prev_destroy_limit = current_limit - quantity.amount;
-    st.prev_destroy_time  = timestamp;
-    settings_table.set(st, get_self());
-
     EMIT_DESTROY_EVENT(from, quantity);
     EMIT_X_TRANSFER_EVENT(blockchain, target, quantity, x_transfer_id);
+
+    collect_garbage();
+}
+
+// consumes from the `direction` (`issue` or `destroy`) bucket of a blockchain, or from the limit all blockchains
+// share in the settings while no blockchain was added, as a contract upgraded from the shared limits does
+void BancorX::consume_limit(name direction, const string& blockchain, uint64_t amount) {
+    settings settings_table(get_self(), get_self().value);
+    auto st = settings_table.get();
+
+    const bool issue = direction == "issue"_n;
+    limiter bucket_limiter(get_self(), direction, issue ? st.max_issue_limit : st.max_destroy_limit, st.limit_inc);
+    if (!bucket_limiter.empty()) {
+        check(bucket_limiter.has(blockchain), "unsupported blockchain");
+        bucket_limiter.consume(blockchain, amount);
+        return;
+    }
+
+    uint64_t& prev_limit = issue ? st.prev_issue_limit : st.prev_destroy_limit;
+    uint64_t& prev_time = issue ? st.prev_issue_time : st.prev_destroy_time;
+    const uint64_t current_time = current_time_point().sec_since_epoch();
+    const uint64_t current_limit = bucket_limiter.refill(prev_limit, prev_time, current_time);
+    check(amount <= current_limit, "above max limit");
+
+    prev_limit = current_limit - amount;
+    prev_time = current_time;
+    settings_table.set(st, get_self());
+}
+
+// reclaims a bounded number of expired rows, resuming where the previous call stopped
+void BancorX::collect_garbage() {
+    gc_state gc_table(get_self(), get_self().value);
+    auto gc = gc_table.get_or_default();
+
+    uint64_t timestamp = current_time_point().sec_since_epoch();
+
+    transfers transfers_table(get_self(), get_self().value);
+    gc.transfers_cursor = collect_expired(transfers_table, gc.transfers_cursor, TRANSFER_EXPIRY, timestamp);
+
+    gc_table.set(gc, get_self());
+}
+
+// visits up to MAX_GC_ROWS rows starting at `cursor` and erases the expired ones,
+// returns the primary key to resume from (0 once the end of the table is reached)
+template <typename T>
+uint64_t BancorX::collect_expired(T& table, uint64_t cursor, uint64_t expiry, uint64_t timestamp) {
+    auto itr = table.lower_bound(cursor);
+
+    for (uint8_t i = 0; i < MAX_GC_ROWS && itr != table.end(); i++) {
+        // rows created before timestamps were recorded start expiring from the first time they are visited
+        if (!itr->timestamp.has_value()) {
+            table.modify(itr, same_payer, [&](auto& row) {
+                row.timestamp.emplace(timestamp);
+            });
+            itr++;
+        }
+        else if (itr->timestamp.value() + expiry <= timestamp)
+            itr = table.erase(itr);
+        else
+            itr++;
+    }
+
+    return itr == table.end() ? 0 : itr->primary_key();
 }
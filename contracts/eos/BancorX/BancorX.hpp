@@ -11,6 +11,9 @@
 #include <eosio/asset.hpp>
 #include <eosio/symbol.hpp>
 #include <eosio/singleton.hpp>
+#include <eosio/binary_extension.hpp>
+
+#include "../Common/limiter.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -29,45 +32,45 @@ using namespace std;
 
 /// triggered when an account initiates a cross chain transafer
 #define EMIT_X_TRANSFER_EVENT(blockchain, target, quantity, id) \
-    START_EVENT("xtransfer", "1.2") \
-    EVENTKV("blockchain",blockchain) \
-    EVENTKV("target",target) \
-    EVENTKV("quantity",quantity) \
-    EVENTKVL("id",id) \
-    END_EVENT()
+    emit_event("xtransfer", "1.2", \
+        event_kv("blockchain", blockchain), \
+        event_kv("target", target), \
+        event_kv("quantity", quantity), \
+        event_kv("id", id) \
+    )
 
 /// triggered when account tokens are destroyed after cross chain transfer initiation
 #define EMIT_DESTROY_EVENT(from, quantity) \
-    START_EVENT("destroy", "1.1") \
-    EVENTKV("from",from) \
-    EVENTKVL("quantity",quantity) \
-    END_EVENT()
+    emit_event("destroy", "1.1", \
+        event_kv("from", from), \
+        event_kv("quantity", quantity) \
+    )
 
 /// triggered when a reporter reports a cross chain transfer from another blockchain
 #define EMIT_TX_REPORT_EVENT(reporter, blockchain, transaction, target, quantity, x_transfer_id, memo) \
-    START_EVENT("txreport", "1.2") \
-    EVENTKV("reporter",reporter) \
-    EVENTKV("from_blockchain",blockchain) \
-    EVENTKV("transaction",transaction) \
-    EVENTKV("target",target) \
-    EVENTKV("quantity",quantity) \
-    EVENTKV("x_transfer_id",x_transfer_id) \
-    EVENTKVL("memo",memo) \
-    END_EVENT()
+    emit_event("txreport", "1.2", \
+        event_kv("reporter", reporter), \
+        event_kv("from_blockchain", blockchain), \
+        event_kv("transaction", transaction), \
+        event_kv("target", target), \
+        event_kv("quantity", quantity), \
+        event_kv("x_transfer_id", x_transfer_id), \
+        event_kv("memo", memo) \
+    )
 
 /// triggered when final report is succesfully submitted
 #define EMIT_X_TRANSFER_COMPLETE_EVENT(target, id) \
-    START_EVENT("xtransfercomplete", "1.2") \
-    EVENTKV("target", target) \
-    EVENTKVL("id", id) \
-    END_EVENT()
+    emit_event("xtransfercomplete", "1.2", \
+        event_kv("target", target), \
+        event_kv("id", id) \
+    )
 
 /// triggered when enough reports arrived and tokens are issued to an account and the cross chain transfer is fulfilled
 #define EMIT_ISSUE_EVENT(target, quantity) \
-    START_EVENT("issue", "1.1") \
-    EVENTKV("target",target) \
-    EVENTKVL("quantity",quantity) \
-    END_EVENT()
+    emit_event("issue", "1.1", \
+        event_kv("target", target), \
+        event_kv("quantity", quantity) \
+    )
 
 /*! \cond DOCS_EXCLUDE */
 CONTRACT BancorX : public contract { /*! \endcond */
@@ -87,11 +90,31 @@ CONTRACT BancorX : public contract { /*! \endcond */
                 uint64_t min_limit;
                 uint64_t limit_inc;
                 uint64_t max_issue_limit;
-                uint64_t prev_issue_limit;
-                uint64_t prev_issue_time;
+                uint64_t prev_issue_limit;   // shared by all blockchains until the first `addchain`
+                uint64_t prev_issue_time;    // shared by all blockchains until the first `addchain`
                 uint64_t max_destroy_limit;
-                uint64_t prev_destroy_limit;
-                uint64_t prev_destroy_time;
+                uint64_t prev_destroy_limit; // shared by all blockchains until the first `addchain`
+                uint64_t prev_destroy_time;  // shared by all blockchains until the first `addchain`
+            }; /** @}*/
+
+        /**
+         * @defgroup Buckets_Table Buckets Table
+         * @brief This table stores the rate limiter state for issuing and destroying tokens, one bucket per supported blockchain
+         * @details SCOPE of this table is either `issue` or `destroy`, PRIMARY KEY is a hash of the blockchain name;
+         * rows are added by `addchain`, transfers from or to other blockchains are rejected; until the first one is added
+         * (e.g. right after upgrading a contract that had a single limit) all blockchains share the `settings` limits
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            TABLE bucket_t { /*! \endcond */
+                uint64_t id;
+                string   key;
+                uint64_t prev_limit;
+                uint64_t prev_time;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return id; }
+                /*! \endcond */
+
             }; /** @}*/
 
         /**
@@ -109,6 +132,11 @@ CONTRACT BancorX : public contract { /*! \endcond */
                 string       data;
                 vector<name> reporters;
 
+                /**
+                 * @brief time (in seconds) of the first report, rows that don't reach quorum expire `TRANSFER_EXPIRY` seconds later
+                 */
+                binary_extension<uint64_t> timestamp;
+
                 /*! \cond DOCS_EXCLUDE */
                 uint64_t     primary_key() const { return tx_id; }
                 /*! \endcond */
@@ -131,6 +159,16 @@ CONTRACT BancorX : public contract { /*! \endcond */
 
             }; /** @}*/
 
+        /**
+         * @defgroup GC_State_Table GC State Table
+         * @brief This table stores where the incremental garbage collection of expired transfers resumes
+         * @details `amounts` rows never expire, they are the record that an `x_transfer_id` was already issued
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            TABLE gc_state_t { /*! \endcond */
+                uint64_t transfers_cursor;
+            }; /** @}*/
+
         /**
          * @defgroup Reporters_Table Reporters Table
          * @brief This table stores the account names of BancorX reporters
@@ -151,8 +189,9 @@ CONTRACT BancorX : public contract { /*! \endcond */
          * @param x_token_name - cross chain token account
          * @param min_reporters - minimum required number of reporters to fulfill a cross chain transfer
          * @param min_limit - minimum amount that can be transferred out (destroyed)
-         * @param max_issue_limit - maximum amount that can be issued on EOS in a given timespan
-         * @param max_destroy_limit - maximum amount that can be transferred out (destroyed) in a given timespan
+         * @param limit_inc - amount by which the issue and destroy limits of every blockchain are replenished per second
+         * @param max_issue_limit - maximum amount that can be issued on EOS from a single blockchain in a given timespan
+         * @param max_destroy_limit - maximum amount that can be transferred out (destroyed) to a single blockchain in a given timespan
          */
         ACTION init(name x_token_name, uint64_t min_reporters, uint64_t min_limit, uint64_t limit_inc, uint64_t max_issue_limit, uint64_t max_destroy_limit);
 
@@ -191,6 +230,20 @@ CONTRACT BancorX : public contract { /*! \endcond */
          */
         ACTION rmreporter(name reporter);
 
+        /**
+         * @brief adds a blockchain that tokens can be transferred from and to, can only be called by the contract account
+         * @details its issue and destroy limits start from the limits all blockchains shared in the settings
+         * @param blockchain - name of the blockchain, as used in x transfer memos and reports
+         */
+        ACTION addchain(string blockchain);
+
+        /**
+         * @brief removes a supported blockchain, can only be called by the contract account
+         * @details the last one can't be removed, disable reporting and x transfers instead
+         * @param blockchain - name of the blockchain
+         */
+        ACTION rmchain(string blockchain);
+
         /**
          * @brief reports an incoming transaction from a different blockchain
          * @details can only be called by an existing reporter
@@ -202,6 +255,7 @@ CONTRACT BancorX : public contract { /*! \endcond */
          * @param quantity - amount to issue to the target account if the minimum required number of reports is met
          * @param memo - memo to pass in in the transfer action
          * @param data - custom source blockchain value, usually a string representing the tx hash on the source blockchain
+         * @details also reclaims up to `MAX_GC_ROWS` expired rows from the transfers table
          */
         ACTION reporttx(name reporter, string blockchain, uint64_t tx_id, uint64_t x_transfer_id, name target, asset quantity, string memo, string data);
 
@@ -229,6 +283,13 @@ CONTRACT BancorX : public contract { /*! \endcond */
         typedef eosio::multi_index<"transfers"_n, transfer_t> transfers;
         typedef eosio::multi_index<"amounts"_n, amounts_t> amounts;
         typedef eosio::multi_index<"reporters"_n, reporter_t> reporters;
+        typedef eosio::multi_index<"buckets"_n, bucket_t> buckets;
+        typedef eosio::singleton<"gcstate"_n, gc_state_t> gc_state;
+        typedef eosio::multi_index<"gcstate"_n, gc_state_t> dummy_gc_for_abi; // hack until abi generator generates correct name
+        typedef rate_limiter<buckets> limiter;
+
+        constexpr static uint64_t TRANSFER_EXPIRY = 7 * 24 * 60 * 60;
+        constexpr static uint8_t MAX_GC_ROWS = 2;
 
         struct memo_x_transfer {
             string version;
@@ -239,6 +300,12 @@ CONTRACT BancorX : public contract { /*! \endcond */
 
         void xtransfer(string blockchain, name from, string target, asset quantity, string x_transfer_id);
 
+        void consume_limit(name direction, const string& blockchain, uint64_t amount);
+        void collect_garbage();
+
+        template <typename T>
+        uint64_t collect_expired(T& table, uint64_t cursor, uint64_t expiry, uint64_t timestamp);
+
         memo_x_transfer parse_memo(string memo) {
             auto res = memo_x_transfer();
             auto parts = split(memo, ",");
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <math.h>
 #include "events.hpp"
+#include "curves.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -112,8 +113,25 @@ float stof(const char* s) {
     return rez * fact;
 }
 
+// asserts if a conversion resulted in an amount lower than the minimum amount defined by the caller
+void verify_min_return(asset quantity, string min_return) {
+    float ret = stof(min_return.c_str());
+    uint64_t ret_amount = ret * pow(10, quantity.symbol.precision());
+    if (ret_amount)
+        check(quantity.amount >= ret_amount, "below min return");
+    else
+        check(quantity.amount > 0, "return must be above zero");
+}
+
+// whether `quantity` meets a memo's minimum return, like `verify_min_return` without failing
+bool meets_min_return(asset quantity, string min_return) {
+    float ret = stof(min_return.c_str());
+    uint64_t ret_amount = ret * pow(10, quantity.symbol.precision());
+    return ret_amount ? quantity.amount >= ret_amount : quantity.amount > 0;
+}
+
 double calculate_fee(double amount, uint64_t fee, uint8_t magnitude) {
-    return amount * (1 - pow((1 - fee / MAX_FEE), magnitude));
+    return curves::conversion_fee(amount, fee, magnitude);
 }
 
 uint64_t stoui(string const& value) {
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+/**
+ * @brief bancor bonding curve formulas, specialized for the common reserve weights
+ * @details every formula raises a ratio to `weight / MAX_WEIGHT` or to its inverse, which for the common
+ * weights reduces to a plain multiply/divide (100%) or to `sqrt` / a square (50%), so a general `pow` is only
+ * paid for the remaining weights.
+ * The 100% formulas keep the exact operations of the `pow` versions (`pow(x, 1.0) == x`), so their returns are
+ * bit for bit unchanged; `sqrt` and the square may differ from `pow` in the last bit of the power.
+ * The formulas are templated on the weight class; the non-template overloads dispatch on the runtime weight.
+ * There is no 1/3 class: it isn't representable in ppm, and replacing the 333333 ppm exponent with an exact
+ * `cbrt` / cube moves returns by up to ~3 ppm, while `cbrt` isn't cheaper than `pow` to begin with.
+ * The header only depends on libc math, so the same code can be compiled for host tools.
+ */
+namespace curves {
+    constexpr double MAX_WEIGHT = 1000000.0;
+    constexpr double MAX_FEE = 1000000.0;
+
+    enum class weight_class { full, half, general };
+
+    template <weight_class W>
+    using weight_class_t = std::integral_constant<weight_class, W>;
+
+    inline weight_class classify(const double weight) {
+        if (weight == MAX_WEIGHT) return weight_class::full;
+        if (weight == MAX_WEIGHT / 2) return weight_class::half;
+        return weight_class::general;
+    }
+
+    // calls `curve` with the weight class of `weight` as a `weight_class_t`
+    template <typename F>
+    double dispatch(const double weight, F&& curve) {
+        switch (classify(weight)) {
+            case weight_class::full:  return curve(weight_class_t<weight_class::full>());
+            case weight_class::half:  return curve(weight_class_t<weight_class::half>());
+            default:                  return curve(weight_class_t<weight_class::general>());
+        }
+    }
+
+    // base ^ (weight / MAX_WEIGHT)
+    template <weight_class W>
+    double pow_weight(const double base, const double weight) {
+        if constexpr (W == weight_class::full) return base;
+        else if constexpr (W == weight_class::half) return sqrt(base);
+        else return pow(base, weight / MAX_WEIGHT);
+    }
+
+    // base ^ (MAX_WEIGHT / weight)
+    template <weight_class W>
+    double pow_inverse_weight(const double base, const double weight) {
+        if constexpr (W == weight_class::full) return base;
+        else if constexpr (W == weight_class::half) return base * base;
+        else return pow(base, MAX_WEIGHT / weight);
+    }
+
+    // reserve --> smart token: supply * ((1 + amount / balance) ^ (weight / MAX_WEIGHT) - 1)
+    template <weight_class W>
+    double purchase_return(const double supply, const double balance, const double amount, const double weight) {
+        if constexpr (W == weight_class::full) return supply * ((1.0 + amount / balance) - 1.0);
+        else return supply * (pow_weight<W>(1.0 + amount / balance, weight) - 1.0);
+    }
+
+    // smart token --> reserve: balance * (1 - (1 - amount / supply) ^ (MAX_WEIGHT / weight))
+    template <weight_class W>
+    double sale_return(const double supply, const double balance, const double amount, const double weight) {
+        if constexpr (W == weight_class::full) return balance * (1.0 - (1.0 - amount / supply));
+        else return balance * (1.0 - pow_inverse_weight<W>(1.0 - amount / supply, weight));
+    }
+
+    // reserve amount needed to fund `amount` smart tokens: balance * (((supply + amount) / supply) ^ (MAX_WEIGHT / total_weight) - 1)
+    template <weight_class W>
+    double fund_cost(const double supply, const double balance, const double amount, const double total_weight) {
+        if constexpr (W == weight_class::full) return balance * amount / supply;
+        else return balance * (pow_inverse_weight<W>((supply + amount) / supply, total_weight) - 1.0);
+    }
+
+    // reserve amount returned for liquidating `amount` smart tokens: balance * (1 - ((supply - amount) / supply) ^ (MAX_WEIGHT / total_weight))
+    template <weight_class W>
+    double liquidate_return(const double supply, const double balance, const double amount, const double total_weight) {
+        if constexpr (W == weight_class::full) return amount * balance / supply;
+        else return balance * (1.0 - pow_inverse_weight<W>((supply - amount) / supply, total_weight));
+    }
+
+    // reserve --> reserve: to_balance * (1 - (from_balance / (from_balance + amount)) ^ (from_weight / to_weight)),
+    // a purchase followed by a sale without the intermediate smart token amount
+    inline double cross_reserve_return(const double from_balance, const double amount, const double to_balance, const double from_weight, const double to_weight) {
+        if (from_weight == to_weight) return amount / (from_balance + amount) * to_balance;
+        return to_balance * (1.0 - pow(from_balance / (from_balance + amount), from_weight / to_weight));
+    }
+
+    // the uniform price (in b per a, before fees) of a batch selling `amount_a` of reserve a for b and `amount_b` of b for a:
+    // the opposite sides are matched at that price and the pool only converts the excess, at an average price of at
+    // least the clearing price, so it never pays out more than `cross_reserve_return` of the excess
+    inline double clearing_price(const double balance_a, const double weight_a, const double amount_a,
+                                 const double balance_b, const double weight_b, const double amount_b) {
+        const double spot = (balance_b / weight_b) / (balance_a / weight_a);
+        if (amount_a * spot < amount_b) return 1 / clearing_price(balance_b, weight_b, amount_b, balance_a, weight_a, amount_a);
+        if (amount_a == 0) return spot;
+
+        // excess of a: the pool converts `amount_a - amount_b / price`, its average price falls as the price (and the excess) rises
+        double low = amount_b / amount_a, high = spot;
+        for (int i = 0; i < 100 && high - low > spot * 1e-15; i++) {
+            const double price = (low + high) / 2;
+            const double excess = amount_a - amount_b / price;
+            if (cross_reserve_return(balance_a, excess, balance_b, weight_a, weight_b) >= excess * price) low = price;
+            else high = price;
+        }
+        return low;
+    }
+
+    // the part of a return taken as the conversion fee, charged once per `magnitude` (2 for reserve --> reserve)
+    inline double conversion_fee(const double amount, const uint64_t fee, const uint8_t magnitude) {
+        return amount * (1 - pow((1 - fee / MAX_FEE), magnitude));
+    }
+
+    inline double purchase_return(const double supply, const double balance, const double amount, const double weight) {
+        return dispatch(weight, [&](auto w) { return purchase_return<decltype(w)::value>(supply, balance, amount, weight); });
+    }
+
+    inline double sale_return(const double supply, const double balance, const double amount, const double weight) {
+        return dispatch(weight, [&](auto w) { return sale_return<decltype(w)::value>(supply, balance, amount, weight); });
+    }
+
+    inline double fund_cost(const double supply, const double balance, const double amount, const double total_weight) {
+        return dispatch(total_weight, [&](auto w) { return fund_cost<decltype(w)::value>(supply, balance, amount, total_weight); });
+    }
+
+    inline double liquidate_return(const double supply, const double balance, const double amount, const double total_weight) {
+        return dispatch(total_weight, [&](auto w) { return liquidate_return<decltype(w)::value>(supply, balance, amount, total_weight); });
+    }
+}
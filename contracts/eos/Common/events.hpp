@@ -1,35 +1,164 @@
+#pragma once
 
-using eosio::print;
-
-#define EVENTKV(key, value) \
-{ \
-    print('"'); \
-    print(key); \
-    print('"'); \
-    print(':'); \
-    print('"'); \
-    print(value); \
-    print('"'); \
-    print(",");\
-} while(0);
-
-#define EVENTKVL(key, value) \
-{ \
-    print('"'); \
-    print(key); \
-    print('"'); \
-    print(':'); \
-    print('"'); \
-    print(value); \
-    print('"'); \
-} while(0);
-
-#define START_EVENT(etype, version) \
-{ \
-    print("{"); \
-    EVENTKV("version",version) \
-    EVENTKV("etype",etype) \
+#include <eosio/print.hpp>
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+#include <eosio/asset.hpp>
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * @brief JSON event serializer
+ * @details events are written as a single line JSON object into a fixed stack buffer, which is flushed
+ * with one `printl` call (only events larger than the buffer are printed in more than one call), e.g.
+ *
+ * emit_event("xtransfer", "1.2", event_kv("blockchain", blockchain), event_kv("id", id));
+ *
+ * prints `{"version":"1.2","etype":"xtransfer","blockchain":"eth","id":"1"}\n`
+ * keys are expected to be plain literals, all values are written as escaped JSON strings
+ */
+template <size_t N>
+class event_writer {
+    public:
+        ~event_writer() { flush(); }
+
+        void append(char c) {
+            if (_size == N) flush();
+            _buffer[_size++] = c;
+        }
+
+        void append(const char* str, size_t len) {
+            while (len) {
+                if (_size == N) flush();
+                const size_t chunk = std::min(len, N - _size);
+                memcpy(_buffer + _size, str, chunk);
+                _size += chunk;
+                str += chunk;
+                len -= chunk;
+            }
+        }
+
+        void append_escaped(const char* str, size_t len) {
+            constexpr char hex[] = "0123456789abcdef";
+            for (size_t i = 0; i < len; i++) {
+                const unsigned char c = str[i];
+                switch (c) {
+                    case '"':  append("\\\"", 2); break;
+                    case '\\': append("\\\\", 2); break;
+                    case '\n': append("\\n", 2); break;
+                    case '\r': append("\\r", 2); break;
+                    case '\t': append("\\t", 2); break;
+                    default:
+                        if (c < 0x20) {
+                            const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+                            append(escaped, sizeof(escaped));
+                        }
+                        else append(c);
+                }
+            }
+        }
+
+        void write(const std::string& value) { append_escaped(value.data(), value.size()); }
+        void write(const char* value) { append_escaped(value, strlen(value)); }
+        void write(const eosio::name value) { write(value.to_string()); }
+        void write(const eosio::symbol_code value) { write(value.to_string()); }
+        void write(const eosio::asset& value) { write(value.to_string()); }
+        void write(const bool value) { value ? append("true", 4) : append("false", 5); }
+
+        template <typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        void write(const T value) {
+            char digits[20];
+            size_t pos = sizeof(digits);
+            uint64_t abs = value < 0 ? -static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            do {
+                digits[--pos] = '0' + abs % 10;
+                abs /= 10;
+            } while (abs);
+
+            if (value < 0) append('-');
+            append(digits + pos, sizeof(digits) - pos);
+        }
+
+        // fixed notation with up to DOUBLE_DECIMALS decimal places, trailing zeros trimmed
+        void write(double value) {
+            if (value != value) return append("nan", 3);
+            if (value < 0) {
+                append('-');
+                value = -value;
+            }
+            if (value >= 1e19) return write(std::to_string(value));
+
+            uint64_t integral = static_cast<uint64_t>(value);
+            uint64_t fraction = static_cast<uint64_t>((value - integral) * DOUBLE_SCALE + 0.5);
+            if (fraction >= DOUBLE_SCALE) {
+                integral++;
+                fraction -= DOUBLE_SCALE;
+            }
+            write(integral);
+            if (!fraction) return;
+
+            char digits[DOUBLE_DECIMALS];
+            size_t len = DOUBLE_DECIMALS;
+            for (size_t i = DOUBLE_DECIMALS; i > 0; i--) {
+                digits[i - 1] = '0' + fraction % 10;
+                fraction /= 10;
+            }
+            while (digits[len - 1] == '0') len--;
+
+            append('.');
+            append(digits, len);
+        }
+
+        template <size_t K, typename T>
+        void field(const char (&key)[K], const T& value, bool first = false) {
+            if (!first) append(',');
+            append('"');
+            append(key, K - 1);
+            append("\":\"", 3);
+            write(value);
+            append('"');
+        }
+
+        void flush() {
+            if (!_size) return;
+            eosio::printl(_buffer, _size);
+            _size = 0;
+        }
+
+    private:
+        constexpr static size_t DOUBLE_DECIMALS = 10;
+        constexpr static uint64_t DOUBLE_SCALE = 10000000000ULL;
+
+        char   _buffer[N];
+        size_t _size = 0;
+};
+
+/**
+ * @brief a key/value pair of an event, built with `event_kv`
+ */
+template <size_t K, typename T>
+struct event_field {
+    const char (&key)[K];
+    const T& value;
+};
+
+template <size_t K, typename T>
+constexpr event_field<K, T> event_kv(const char (&key)[K], const T& value) {
+    return { key, value };
 }
 
-#define END_EVENT() \
-    print("}\n");
+constexpr static size_t EVENT_BUFFER_SIZE = 512;
+
+template <size_t E, size_t V, size_t... K, typename... T>
+void emit_event(const char (&etype)[E], const char (&version)[V], const event_field<K, T>&... fields) {
+    event_writer<EVENT_BUFFER_SIZE> writer;
+
+    writer.append('{');
+    writer.field("version", version, true);
+    writer.field("etype", etype);
+    (writer.field(fields.key, fields.value), ...);
+    writer.append("}\n", 2);
+}
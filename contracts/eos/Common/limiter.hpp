@@ -0,0 +1,147 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+
+#include <string>
+#include <algorithm>
+
+using namespace eosio;
+using namespace std;
+
+/**
+ * @brief token-bucket rate limiter
+ * @details keeps one bucket per `key` (e.g. a blockchain name) in its own small table, so that consuming
+ * from a bucket only rewrites that bucket's row, never the contract settings.
+ * Buckets are only created by `add`, so the keys that can be consumed from are a fixed set the contract
+ * controls (and pays the RAM for); each bucket refills by `limit_inc` per second up to `max_limit`.
+ * `T` is a multi_index whose rows provide the fields:
+ * - `uint64_t id` - PRIMARY KEY, `bucket_id(key)`
+ * - `string key` - the bucket key, kept to detect id collisions
+ * - `uint64_t prev_limit` - amount left in the bucket at `prev_time`
+ * - `uint64_t prev_time` - last time (in seconds) the bucket was consumed from
+ * The table SCOPE separates independent families of buckets (e.g. issue vs. destroy).
+ */
+template <typename T>
+class rate_limiter {
+    public:
+        rate_limiter(name code, name scope, uint64_t max_limit, uint64_t limit_inc)
+            : _buckets(code, scope.value), _max_limit(max_limit), _limit_inc(limit_inc) {}
+
+        /**
+         * @brief whether a bucket exists for a key
+         * @param key - bucket key
+         */
+        bool has(const string& key) const {
+            const auto bucket = _buckets.find(bucket_id(key));
+            return bucket != _buckets.end() && bucket->key == key;
+        }
+
+        /**
+         * @brief whether no bucket exists at all
+         */
+        bool empty() const {
+            return _buckets.begin() == _buckets.end();
+        }
+
+        /**
+         * @brief creates a bucket holding `limit` (up to `max_limit`), asserts if it already exists
+         * @param key - bucket key
+         * @param payer - RAM payer of the bucket
+         * @param limit - amount initially in the bucket
+         */
+        void add(const string& key, name payer, uint64_t limit) {
+            const uint64_t id = bucket_id(key);
+            check(_buckets.find(id) == _buckets.end(), "rate limiter bucket already exists");
+
+            _buckets.emplace(payer, [&](auto& b) {
+                b.id         = id;
+                b.key        = key;
+                b.prev_limit = std::min(limit, _max_limit);
+                b.prev_time  = current_time_point().sec_since_epoch();
+            });
+        }
+
+        /**
+         * @brief creates a full bucket, asserts if it already exists
+         * @param key - bucket key
+         * @param payer - RAM payer of the bucket
+         */
+        void add(const string& key, name payer) {
+            add(key, payer, _max_limit);
+        }
+
+        /**
+         * @brief deletes a bucket, asserts if it doesn't exist
+         * @param key - bucket key
+         */
+        void remove(const string& key) {
+            const auto& bucket = get(key);
+            _buckets.erase(bucket);
+        }
+
+        /**
+         * @brief returns the amount that can currently be consumed from a bucket, asserts if it doesn't exist
+         * @param key - bucket key
+         */
+        uint64_t available(const string& key) const {
+            const auto& bucket = get(key);
+            return refill(bucket.prev_limit, bucket.prev_time, current_time_point().sec_since_epoch());
+        }
+
+        /**
+         * @brief consumes an amount from a bucket, asserts if the bucket doesn't hold enough
+         * @param key - bucket key
+         * @param amount - amount to consume
+         */
+        void consume(const string& key, uint64_t amount) {
+            const uint64_t timestamp = current_time_point().sec_since_epoch();
+            const auto& bucket = get(key);
+
+            const uint64_t current_limit = refill(bucket.prev_limit, bucket.prev_time, timestamp);
+            check(amount <= current_limit, "above max limit");
+
+            _buckets.modify(bucket, same_payer, [&](auto& b) {
+                b.prev_limit = current_limit - amount;
+                b.prev_time  = timestamp;
+            });
+        }
+
+        /**
+         * @brief 64-bit FNV-1a hash of a bucket key, used as the bucket's PRIMARY KEY
+         */
+        static uint64_t bucket_id(const string& key) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (const unsigned char c : key) {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief amount in a bucket at `timestamp` that held `prev_limit` at `prev_time`, for state kept outside the table
+         */
+        uint64_t refill(uint64_t prev_limit, uint64_t prev_time, uint64_t timestamp) const {
+            if (prev_limit >= _max_limit || timestamp <= prev_time)
+                return std::min(prev_limit, _max_limit);
+
+            // avoid overflowing `limit_inc * delta` after long idle periods
+            const uint64_t delta = timestamp - prev_time;
+            if (delta > (_max_limit - prev_limit) / _limit_inc)
+                return _max_limit;
+
+            return prev_limit + _limit_inc * delta;
+        }
+
+    private:
+        T        _buckets;
+        uint64_t _max_limit;
+        uint64_t _limit_inc;
+
+        const auto& get(const string& key) const {
+            const auto& bucket = _buckets.get(bucket_id(key), "unknown rate limiter bucket");
+            check(bucket.key == key, "rate limiter bucket collision");
+            return bucket;
+        }
+};
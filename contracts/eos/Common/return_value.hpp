@@ -0,0 +1,30 @@
+#pragma once
+
+#include <eosio/action.hpp>
+#include <eosio/datastream.hpp>
+
+#include <utility>
+
+/**
+ * @brief `eosio::set_action_return_value` for toolchains older than eosio.cdt v1.8
+ * @details the packed value is recorded in the action trace (`return_value_data`). A contract using it imports the
+ * `set_action_return_value` intrinsic, so its `setcode` fails unless the chain runs nodeos 2.1+ with the
+ * `ACTION_RETURN_VALUE` protocol feature activated (see scripts/deploy/system_contracts.sh); newer toolchains
+ * provide the same function
+ */
+#if !defined(__eosio_cdt_major__) || (__eosio_cdt_major__ == 1 && __eosio_cdt_minor__ < 8)
+namespace eosio {
+    namespace internal_use_do_not_use {
+        extern "C" {
+            __attribute__((eosio_wasm_import))
+            void set_action_return_value(void* return_value, size_t size);
+        }
+    }
+
+    template <typename T>
+    void set_action_return_value(T&& return_value) {
+        auto packed = eosio::pack(std::forward<T>(return_value));
+        internal_use_do_not_use::set_action_return_value(packed.data(), packed.size());
+    }
+}
+#endif
@@ -23,3 +23,49 @@ ACTION XTransferRerouter::reroutetx(uint64_t tx_id, string blockchain, string ta
 
     EMIT_TX_REROUTE_EVENT(tx_id, blockchain, target);
 }
+
+ACTION XTransferRerouter::setreroute(name sender, uint64_t tx_id, string blockchain, string target) {
+    settings settings_table(get_self(), get_self().value);
+    auto st = settings_table.get();
+
+    check(st.rrt_enabled, "transaction rerouting is disabled");
+
+    set_reroute(sender, tx_id, blockchain, target);
+}
+
+ACTION XTransferRerouter::reroutetxs(vector<reroute_t> reroutes) {
+    settings settings_table(get_self(), get_self().value);
+    auto st = settings_table.get();
+
+    check(st.rrt_enabled, "transaction rerouting is disabled");
+    check(!reroutes.empty(), "no reroutes given");
+
+    for (const auto& r : reroutes)
+        set_reroute(r.sender, r.tx_id, r.blockchain, r.target);
+}
+
+// records the latest destination of a sender's transaction in the sender's scope, where only the sender or the
+// contract can write, so no one can claim another sender's `tx_id`
+void XTransferRerouter::set_reroute(name sender, uint64_t tx_id, const string& blockchain, const string& target) {
+    const bool by_sender = has_auth(sender);
+    if (!by_sender) check(has_auth(get_self()), "missing authority of " + sender.to_string());
+
+    reroutes reroutes_table(get_self(), sender.value);
+    auto existing = reroutes_table.find(tx_id);
+    if (existing == reroutes_table.end()) {
+        reroutes_table.emplace(by_sender ? sender : get_self(), [&](auto& r) {
+            r.tx_id      = tx_id;
+            r.blockchain = blockchain;
+            r.target     = target;
+            r.sender     = sender;
+        });
+    }
+    else {
+        reroutes_table.modify(existing, same_payer, [&](auto& r) {
+            r.blockchain = blockchain;
+            r.target     = target;
+        });
+    }
+
+    EMIT_TX_REROUTE_EVENT(tx_id, blockchain, target);
+}
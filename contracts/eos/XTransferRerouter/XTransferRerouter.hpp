@@ -20,11 +20,11 @@ using namespace std;
 
 /// events triggered when an account reroutes an xtransfer transaction
 #define EMIT_TX_REROUTE_EVENT(tx_id, blockchain, target) \
-    START_EVENT("txreroute", "1.1") \
-    EVENTKV("tx_id",tx_id) \
-    EVENTKV("blockchain",blockchain) \
-    EVENTKVL("target",target) \
-    END_EVENT()
+    emit_event("txreroute", "1.1", \
+        event_kv("tx_id", tx_id), \
+        event_kv("blockchain", blockchain), \
+        event_kv("target", target) \
+    )
 
 /*! \cond DOCS_EXCLUDE */
 CONTRACT XTransferRerouter : public contract { /*! \endcond */
@@ -41,6 +41,32 @@ CONTRACT XTransferRerouter : public contract { /*! \endcond */
                 bool rrt_enabled;
             }; /** @}*/
 
+        /**
+         * @defgroup Reroutes_Table Reroutes Table
+         * @brief This table stores the latest destination of every rerouted xtransfer transaction
+         * @details SCOPE of this table is the original sender's `name.value` (as recorded by BancorX), PRIMARY KEY is `tx_id`;
+         * rows can only be written by their sender or by the contract
+         * @{
+         *//*! \cond DOCS_EXCLUDE */
+            TABLE reroute_t { /*! \endcond */
+                /// unique transaction id
+                uint64_t tx_id;
+
+                /// target blockchain
+                string blockchain;
+
+                /// target account/address
+                string target;
+
+                /// original sender of the transaction, the row's SCOPE
+                name sender;
+
+                /*! \cond DOCS_EXCLUDE */
+                uint64_t primary_key() const { return tx_id; }
+                /*! \endcond */
+
+            }; /** @}*/
+
         /**
          * @brief can only be called by the contract account
          * @param enable - true to enable rerouting xtransfers, false to disable it
@@ -50,15 +76,37 @@ CONTRACT XTransferRerouter : public contract { /*! \endcond */
         /**
          * @brief only the original sender may reroute an invalid transaction
          * @details allows an account to change xtransfer transaction details if the original transaction
-         * parameters were invalid (e.g non-existent destination blockchain/target)
+         * parameters were invalid (e.g non-existent destination blockchain/target); only logs the reroute, the relayers
+         * check its sender, use `setreroute` to record it in the `reroutes` table
          * @param tx_id - unique transaction id
          * @param blockchain - target blockchain
          * @param target - target account/address
          */
         ACTION reroutetx(uint64_t tx_id, string blockchain, string target);
 
+        /**
+         * @brief records the reroute of an invalid transaction in the sender's scope of the `reroutes` table
+         * @details same as `reroutetx`, the relayers look the latest destination up by sender and `tx_id`
+         * @param sender - original sender of the transaction, must authorize the action and pays for the row
+         * (or the contract, which pays for the rows it creates)
+         * @param tx_id - unique transaction id
+         * @param blockchain - target blockchain
+         * @param target - target account/address
+         */
+        ACTION setreroute(name sender, uint64_t tx_id, string blockchain, string target);
+
+        /**
+         * @brief reroutes multiple xtransfer transactions at once
+         * @details same as calling `setreroute` for each of the given reroutes, every sender must authorize the action
+         * @param reroutes - list of transaction ids with their new target blockchain and account/address and their sender
+         */
+        ACTION reroutetxs(vector<reroute_t> reroutes);
+
     private:
         typedef eosio::singleton<"settings"_n, settings_t> settings;
         typedef eosio::multi_index<"settings"_n, settings_t> dummy_for_abi; // hack until abi generator generates correct name
+        typedef eosio::multi_index<"reroutes"_n, reroute_t> reroutes;
+
+        void set_reroute(name sender, uint64_t tx_id, const string& blockchain, const string& target);
 
 }; /** @}*/
@@ -73,6 +73,7 @@ ACTION BancorConverter::setreserve(name contract, symbol currency, uint64_t rati
         s.currency  = asset(0, currency);
         s.ratio     = ratio;
         s.sale_enabled = sale_enabled;
+        s.balance.emplace(get_balance_amount(contract, get_self(), currency.code()), currency);
     });
     uint64_t total_ratio = 0;
     for (auto& reserve : reserves_table)
@@ -84,7 +85,7 @@ ACTION BancorConverter::setreserve(name contract, symbol currency, uint64_t rati
     settings settings_table(get_self(), get_self().value);
     const auto& converter_settings = settings_table.get("settings"_n.value, "settings do not exist");
 
-    auto current_smart_supply = (get_supply(converter_settings.smart_contract, converter_settings.smart_currency.symbol.code())).amount + converter_settings.smart_currency.amount;
+    auto current_smart_supply = get_smart_supply(converter_settings) + converter_settings.smart_currency.amount;
     current_smart_supply /= pow(10, converter_settings.smart_currency.symbol.precision());
     auto reserve_balance = get_balance_amount(contract, get_self(), currency.code()) / pow(10, currency.precision());
     EMIT_PRICE_DATA_EVENT(current_smart_supply, contract, currency.code(), reserve_balance, ratio / MAX_RATIO);
@@ -103,6 +104,22 @@ ACTION BancorConverter::delreserve(symbol_code currency) {
     reserves_table.erase(rsrv);
 }
 
+ACTION BancorConverter::syncbalances() {
+    require_auth(get_self());
+
+    settings settings_table(get_self(), get_self().value);
+    const auto& converter_settings = settings_table.get("settings"_n.value, "settings do not exist");
+    settings_table.modify(converter_settings, get_self(), [&](auto& s) {
+        s.supply.emplace(get_supply(s.smart_contract, s.smart_currency.symbol.code()));
+    });
+
+    reserves reserves_table(get_self(), get_self().value);
+    for (auto itr = reserves_table.begin(); itr != reserves_table.end(); itr++)
+        reserves_table.modify(itr, get_self(), [&](auto& r) {
+            r.balance.emplace(get_balance_amount(r.contract, get_self(), r.currency.symbol.code()), r.currency.symbol);
+        });
+}
+
 void BancorConverter::convert(name from, eosio::asset quantity, std::string memo, name code) {
     auto from_amount = quantity.amount / pow(10, quantity.symbol.precision());
 
@@ -143,10 +160,15 @@ void BancorConverter::convert(name from, eosio::asset quantity, std::string memo
     check(to_token.sale_enabled, "'to' token purchases disabled");
     check(code == from_contract, "unknown 'from' contract");
 
-    auto current_from_balance = ((get_balance(from_contract, get_self(), from_currency.symbol.code())).amount + from_currency.amount - quantity.amount) / pow(10, from_currency.symbol.precision());
-    auto current_to_balance = ((get_balance(to_contract, get_self(), to_currency.symbol.code())).amount + to_currency.amount) / pow(10, to_currency_precision);
+    // balances before this conversion, the smart token itself has no reserve balance
+    const int64_t from_balance = incoming_smart_token ? 0 : get_reserve_balance(from_token, quantity.amount);
+    const int64_t to_balance = outgoing_smart_token ? 0 : get_reserve_balance(to_token, 0);
+    const int64_t smart_supply = get_smart_supply(converter_settings);
 
-    double current_smart_supply = (get_supply(converter_settings.smart_contract, converter_settings.smart_currency.symbol.code())).amount + converter_settings.smart_currency.amount;
+    auto current_from_balance = (from_balance + from_currency.amount) / pow(10, from_currency.symbol.precision());
+    auto current_to_balance = (to_balance + to_currency.amount) / pow(10, to_currency_precision);
+
+    double current_smart_supply = smart_supply + converter_settings.smart_currency.amount;
     current_smart_supply /= pow(10, converter_settings.smart_currency.symbol.precision());
 
     name final_to = name(memo_object.dest_account.c_str());
@@ -211,6 +233,19 @@ void BancorConverter::convert(name from, eosio::asset quantity, std::string memo
     asset new_asset = asset(to_amount, to_currency.symbol);
     name inner_to = converter_settings.network;
 
+    // balances after the retire/issue/transfer below
+    if (!incoming_smart_token)
+        set_reserve_balance(from_currency.symbol.code(), from_balance + quantity.amount);
+    if (!outgoing_smart_token) {
+        // the virtual balance (`currency.amount`) may price a return the tracked balance can't pay
+        check(to_balance - new_asset.amount >= 0, "insufficient reserve balance");
+        set_reserve_balance(to_currency.symbol.code(), to_balance - new_asset.amount);
+    }
+
+    const int64_t new_smart_supply = smart_supply + (issue ? new_asset.amount : 0) - (incoming_smart_token ? quantity.amount : 0);
+    if (new_smart_supply != smart_supply || !converter_settings.supply.has_value())
+        set_smart_supply(new_smart_supply);
+
     if (issue)
         action(
             permission_level{ get_self(), "active"_n },
@@ -268,6 +303,39 @@ asset BancorConverter::get_supply(name contract, symbol_code sym) {
     return st.supply;
 }
 
+// returns the converter's balance in a reserve token
+// reserves without a kept balance read the token contract, excluding the incoming transfer being processed (`in_flight`)
+int64_t BancorConverter::get_reserve_balance(const reserve_t& reserve, int64_t in_flight) {
+    if (reserve.balance.has_value())
+        return reserve.balance.value().amount;
+
+    return get_balance_amount(reserve.contract, get_self(), reserve.currency.symbol.code()) - in_flight;
+}
+
+// returns the smart token supply, converters without a kept supply read the token contract
+int64_t BancorConverter::get_smart_supply(const settings_t& settings) {
+    if (settings.supply.has_value())
+        return settings.supply.value().amount;
+
+    return get_supply(settings.smart_contract, settings.smart_currency.symbol.code()).amount;
+}
+
+void BancorConverter::set_reserve_balance(symbol_code currency, int64_t amount) {
+    reserves reserves_table(get_self(), get_self().value);
+    const auto& reserve = reserves_table.get(currency.raw(), "reserve not found");
+    reserves_table.modify(reserve, get_self(), [&](auto& r) {
+        r.balance.emplace(amount, r.currency.symbol);
+    });
+}
+
+void BancorConverter::set_smart_supply(int64_t amount) {
+    settings settings_table(get_self(), get_self().value);
+    const auto& converter_settings = settings_table.get("settings"_n.value, "settings do not exist");
+    settings_table.modify(converter_settings, get_self(), [&](auto& s) {
+        s.supply.emplace(amount, s.smart_currency.symbol);
+    });
+}
+
 // given a token supply, reserve balance, ratio and a input amount (in the reserve token),
 // calculates the return for a given conversion (in the main token)
 double BancorConverter::calculate_purchase_return(double balance, double deposit_amount, double supply, int64_t ratio) {
@@ -309,11 +377,17 @@ void BancorConverter::on_transfer(name from, name to, asset quantity, std::strin
     if (memo == "setup") {
         settings settings_table(get_self(), get_self().value);
         const auto& converter_settings = settings_table.get("settings"_n.value, "settings do not exist");
-        const auto& reserve = get_reserve(quantity.symbol.code().raw(), converter_settings);
+        const auto reserve = get_reserve(quantity.symbol.code().raw(), converter_settings);
+        check(get_first_receiver() == reserve.contract, "unknown 'from' contract");
+        const bool smart_token = quantity.symbol.code() == converter_settings.smart_currency.symbol.code();
+
+        const int64_t balance = get_reserve_balance(reserve, quantity.amount) + quantity.amount;
+        if (!smart_token)
+            set_reserve_balance(quantity.symbol.code(), balance);
 
-        auto current_smart_supply = (get_supply(converter_settings.smart_contract, converter_settings.smart_currency.symbol.code())).amount + converter_settings.smart_currency.amount;
+        auto current_smart_supply = get_smart_supply(converter_settings) + converter_settings.smart_currency.amount;
         current_smart_supply /= pow(10, converter_settings.smart_currency.symbol.precision());
-        auto reserve_balance = get_balance_amount(reserve.contract, get_self(), quantity.symbol.code()) / pow(10, quantity.symbol.precision());
+        auto reserve_balance = balance / pow(10, quantity.symbol.precision());
 
         EMIT_PRICE_DATA_EVENT(current_smart_supply, reserve.contract, quantity.symbol.code(), reserve_balance, reserve.ratio / MAX_RATIO);
     } else
@@ -9,6 +9,7 @@
 #include <eosio/transaction.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/symbol.hpp>
+#include <eosio/binary_extension.hpp>
 
 using namespace eosio;
 using namespace std;
@@ -22,37 +23,34 @@ using namespace std;
 */
 
 /// triggered when a conversion between two tokens occurs
-#define EMIT_CONVERSION_EVENT(memo, from_contract, from_symbol, to_contract, to_symbol, from_amount, to_amount, fee_amount) { \
-    START_EVENT("conversion", "1.3") \
-    EVENTKV("memo", memo) \
-    EVENTKV("from_contract", from_contract) \
-    EVENTKV("from_symbol", from_symbol) \
-    EVENTKV("to_contract", to_contract) \
-    EVENTKV("to_symbol", to_symbol) \
-    EVENTKV("amount", from_amount) \
-    EVENTKV("return", to_amount) \
-    EVENTKVL("conversion_fee", fee_amount) \
-    END_EVENT() \
-}
+#define EMIT_CONVERSION_EVENT(memo, from_contract, from_symbol, to_contract, to_symbol, from_amount, to_amount, fee_amount) \
+    emit_event("conversion", "1.3", \
+        event_kv("memo", memo), \
+        event_kv("from_contract", from_contract), \
+        event_kv("from_symbol", from_symbol), \
+        event_kv("to_contract", to_contract), \
+        event_kv("to_symbol", to_symbol), \
+        event_kv("amount", from_amount), \
+        event_kv("return", to_amount), \
+        event_kv("conversion_fee", fee_amount) \
+    )
 
 /// triggered after a conversion with new tokens price data
-#define EMIT_PRICE_DATA_EVENT(smart_supply, reserve_contract, reserve_symbol, reserve_balance, reserve_ratio) { \
-    START_EVENT("price_data", "1.4") \
-    EVENTKV("smart_supply", smart_supply) \
-    EVENTKV("reserve_contract", reserve_contract) \
-    EVENTKV("reserve_symbol", reserve_symbol) \
-    EVENTKV("reserve_balance", reserve_balance) \
-    EVENTKVL("reserve_ratio", reserve_ratio) \
-    END_EVENT() \
-}
+#define EMIT_PRICE_DATA_EVENT(smart_supply, reserve_contract, reserve_symbol, reserve_balance, reserve_ratio) \
+    emit_event("price_data", "1.4", \
+        event_kv("smart_supply", smart_supply), \
+        event_kv("reserve_contract", reserve_contract), \
+        event_kv("reserve_symbol", reserve_symbol), \
+        event_kv("reserve_balance", reserve_balance), \
+        event_kv("reserve_ratio", reserve_ratio) \
+    )
 
 /// triggered when the conversion fee is updated
-#define EMIT_CONVERSION_FEE_UPDATE_EVENT(prev_fee, new_fee) { \
-    START_EVENT("conversion_fee_update", "1.1") \
-    EVENTKV("prev_fee", prev_fee) \
-    EVENTKVL("new_fee", new_fee) \
-    END_EVENT() \
-}
+#define EMIT_CONVERSION_FEE_UPDATE_EVENT(prev_fee, new_fee) \
+    emit_event("conversion_fee_update", "1.1", \
+        event_kv("prev_fee", prev_fee), \
+        event_kv("new_fee", new_fee) \
+    )
 
 /*! \cond DOCS_EXCLUDE */
 CONTRACT BancorConverter : public eosio::contract { /*! \endcond */
@@ -106,6 +104,12 @@ CONTRACT BancorConverter : public eosio::contract { /*! \endcond */
                  */
                 uint64_t fee;
 
+                /**
+                 * @brief supply of the smart token, kept by the converter as it issues and retires it
+                 * @details converters without it read the `stat` table of the smart token contract, see `syncbalances`
+                 */
+                binary_extension<asset> supply;
+
                 /*! \cond DOCS_EXCLUDE */
                 uint64_t primary_key() const { return "settings"_n.value; }
                 /*! \endcond */
@@ -140,6 +144,12 @@ CONTRACT BancorConverter : public eosio::contract { /*! \endcond */
                  */
                 bool sale_enabled;
 
+                /**
+                 * @brief balance of the converter in the reserve token, kept by the converter as tokens come in and go out
+                 * @details reserves without it read the `accounts` table of the reserve token contract, see `syncbalances`
+                 */
+                binary_extension<asset> balance;
+
                 /*! \cond DOCS_EXCLUDE */
                 uint64_t primary_key() const { return currency.symbol.code().raw(); }
                  /*! \endcond */
@@ -186,6 +196,13 @@ CONTRACT BancorConverter : public eosio::contract { /*! \endcond */
          */
         ACTION delreserve(symbol_code currency);
 
+        /**
+         * @brief syncs the reserve balances and the smart token supply kept by the converter with the token contracts
+         * @details required after tokens were moved out of the converter other than through a conversion,
+         * and initializes the balances of converters that predate them; can only be called by the contract account
+         */
+        ACTION syncbalances();
+
         /**
          * @brief transfer intercepts
          * @details `memo` in csv format, may contain an extra keyword (e.g. "setup") following a semicolon at the end of the conversion path;
@@ -210,6 +227,11 @@ CONTRACT BancorConverter : public eosio::contract { /*! \endcond */
         uint64_t get_balance_amount(name contract, name owner, symbol_code sym);
         asset get_supply(name contract, symbol_code sym);
 
+        int64_t get_reserve_balance(const reserve_t& reserve, int64_t in_flight);
+        int64_t get_smart_supply(const settings_t& settings);
+        void set_reserve_balance(symbol_code currency, int64_t amount);
+        void set_smart_supply(int64_t amount);
+
         double calculate_purchase_return(double balance, double deposit_amount, double supply, int64_t ratio);
         double calculate_sale_return(double balance, double sell_amount, double supply, int64_t ratio);
         double quick_convert(double balance, double in, double toBalance);
@@ -0,0 +1,187 @@
+/**
+ * Measures the CPU, NET and RAM cost of conversions, funds, liquidations and BancorX reports on a local chain,
+ * and compares them against a stored baseline.
+ *
+ * usage (on a chain started with `npm run start`):
+ *   node scripts/bench/chain.js [--iterations 5] [--tolerance 0.15] [--update-baseline] [--check] [--only convert]
+ *
+ * - every scenario runs `iterations` times, the median `cpu_usage_us` and net bytes of the transaction receipts
+ *   and the median RAM delta of the involved accounts are reported
+ * - `--update-baseline` writes the results to scripts/bench/chain-baseline.json
+ * - `--check` exits with 1 if CPU grew by more than `tolerance` or NET/RAM grew at all compared to the baseline
+ */
+const fs = require('fs')
+const path = require('path')
+const config = require('../../config/accountNames.json')
+const { api, rpc, getTableBoundsForSymbol } = require('../../test/eos/common/utils')
+const { reporttx } = require('../../test/eos/common/bancor-x')
+
+const BASELINE_FILE = path.join(__dirname, 'chain-baseline.json')
+
+const user = config.MASTER_ACCOUNT
+const network = config.BANCOR_NETWORK_ACCOUNT
+const multiConverter = config.MULTI_CONVERTER_ACCOUNT
+const multiToken = config.MULTI_TOKEN_ACCOUNT
+const bntToken = config.BNT_TOKEN_ACCOUNT
+const bancorX = config.BANCOR_X_ACCOUNT
+const reporter = config.REPORTER_1_ACCOUNT
+const reserveToken = 'aaa' // eosio.token deployed by scripts/deploy/test_contracts.sh
+
+// converters with BNT and 1..3 of the reserve tokens below, all weights equal
+const RESERVE_SYMBOLS = ['BNCHRA', 'BNCHRB', 'BNCHRC']
+const CONVERTERS = { 2: 'BNCHXB', 3: 'BNCHXC', 4: 'BNCHXD' }
+const RAM_ACCOUNTS = [user, network, multiConverter, multiToken, bntToken, reserveToken, bancorX]
+
+const args = process.argv.slice(2)
+const option = (name, fallback) => {
+    const index = args.indexOf(`--${name}`)
+    return index === -1 ? fallback : args[index + 1]
+}
+const ITERATIONS = Number(option('iterations', 5))
+const TOLERANCE = Number(option('tolerance', 0.15))
+const ONLY = option('only', '')
+
+const push = (account, name, data, actor = user) => api.transact({
+    actions: [{ account, name, authorization: [{ actor, permission: 'active' }], data }]
+}, {
+    blocksBehind: 3,
+    expireSeconds: 30,
+})
+
+const transfer = (token, to, quantity, memo, from = user) =>
+    push(token, 'transfer', { from, to, quantity, memo }, from)
+
+const median = values => {
+    const sorted = [...values].sort((a, b) => a - b)
+    return sorted[Math.floor(sorted.length / 2)]
+}
+
+const ramUsage = async () => {
+    const usage = await Promise.all(RAM_ACCOUNTS.map(account => rpc.get_account(account)))
+    return usage.reduce((sum, account) => sum + account.ram_usage, 0)
+}
+
+const ignoreExisting = promise => promise.catch(err => {
+    if (!/already exist|already set|already registered/.test(err.message)) throw err
+})
+
+// creates the reserve tokens and the 2/3/4 reserve converters once, repeated runs reuse them
+async function setup() {
+    for (const symbol of RESERVE_SYMBOLS) {
+        await ignoreExisting(push(reserveToken, 'create', { issuer: user, maximum_supply: `1000000000.0000 ${symbol}` }, reserveToken))
+        await push(reserveToken, 'issue', { to: user, quantity: `1000000.0000 ${symbol}`, memo: 'bench' })
+    }
+
+    for (const [reserves, symbol] of Object.entries(CONVERTERS)) {
+        const existing = await rpc.get_table_rows({ code: multiConverter, scope: multiConverter, table: 'converters', limit: 1, ...getTableBoundsForSymbol(symbol, false) })
+        if (existing.rows.length) continue
+
+        const weight = Math.floor(1000000 / reserves)
+        await push(multiConverter, 'create', { owner: user, token_code: symbol, initial_supply: 10000 })
+        await push(multiConverter, 'setreserve', { converter_currency_code: symbol, currency: '8,BNT', contract: bntToken, ratio: weight })
+        await transfer(bntToken, multiConverter, '100.00000000 BNT', `fund;${symbol}`)
+        for (const reserve of RESERVE_SYMBOLS.slice(0, reserves - 1)) {
+            await push(multiConverter, 'setreserve', { converter_currency_code: symbol, currency: `4,${reserve}`, contract: reserveToken, ratio: weight })
+            await transfer(reserveToken, multiConverter, `10000.0000 ${reserve}`, `fund;${symbol}`)
+        }
+    }
+}
+
+// a path of `hops` conversions alternating BNT --> BNCHRA (2 reserve converter) and BNCHRA --> BNT (3 reserve converter)
+const conversionPath = hops => Array.from({ length: hops }, (_, hop) =>
+    hop % 2 ? `${multiConverter}:${CONVERTERS[3]} BNT` : `${multiConverter}:${CONVERTERS[2]} ${RESERVE_SYMBOLS[0]}`
+).join(' ')
+
+const convert = (hops, memoLength) => () =>
+    transfer(bntToken, network, '0.01000000 BNT', `1,${conversionPath(hops)},0.00000001,${user};${'x'.repeat(memoLength)}`)
+
+const scenarios = [
+    ...[1, 2, 3].flatMap(hops => [0, 128, 512].map(memoLength => ({
+        name: `convert/hops=${hops}/memo=${memoLength}`,
+        run: convert(hops, memoLength)
+    }))),
+    ...Object.entries(CONVERTERS).map(([reserves, symbol]) => ({
+        name: `convert/reserves=${reserves}`,
+        run: () => transfer(bntToken, network, '0.01000000 BNT', `1,${multiConverter}:${symbol} ${symbol},0.00000001,${user}`)
+    })),
+    ...Object.entries(CONVERTERS).map(([reserves, symbol]) => ({
+        name: `fund/reserves=${reserves}`,
+        prepare: async () => {
+            await transfer(bntToken, multiConverter, '1.00000000 BNT', `fund;${symbol}`)
+            for (const reserve of RESERVE_SYMBOLS.slice(0, reserves - 1))
+                await transfer(reserveToken, multiConverter, `100.0000 ${reserve}`, `fund;${symbol}`)
+        },
+        run: () => push(multiConverter, 'fund', { sender: user, quantity: `1.0000 ${symbol}` })
+    })),
+    ...Object.entries(CONVERTERS).map(([reserves, symbol]) => ({
+        name: `liquidate/reserves=${reserves}`,
+        run: () => transfer(multiToken, multiConverter, `1.0000 ${symbol}`, 'liquidate')
+    })),
+    {
+        name: 'bancorx/reporttx',
+        run: () => reporttx({ tx_id: Math.floor(Math.random() * Number.MAX_SAFE_INTEGER), reporter, quantity: '1.00000000 BNT' })
+    }
+]
+
+async function measure(scenario) {
+    const cpu = [], net = [], ram = []
+    for (let i = 0; i < ITERATIONS; i++) {
+        if (scenario.prepare) await scenario.prepare()
+
+        const ramBefore = await ramUsage()
+        const result = await scenario.run()
+        const ramAfter = await ramUsage()
+
+        cpu.push(result.processed.receipt.cpu_usage_us)
+        net.push(result.processed.receipt.net_usage_words * 8)
+        ram.push(ramAfter - ramBefore)
+    }
+    return { cpu_us: median(cpu), net_bytes: median(net), ram_bytes: median(ram) }
+}
+
+const percent = (value, base) => base ? `${value >= base ? '+' : ''}${((value / base - 1) * 100).toFixed(1)}%` : 'n/a'
+
+async function main() {
+    await setup()
+
+    const baseline = fs.existsSync(BASELINE_FILE) ? JSON.parse(fs.readFileSync(BASELINE_FILE)) : {}
+    const results = {}
+    const regressions = []
+
+    console.log(`${'scenario'.padEnd(30)} ${'cpu us'.padStart(8)} ${'net B'.padStart(7)} ${'ram B'.padStart(7)}   vs baseline (cpu / net / ram)`)
+    for (const scenario of scenarios.filter(({ name }) => name.startsWith(ONLY))) {
+        let result
+        try {
+            result = await measure(scenario)
+        } catch (err) {
+            console.log(`${scenario.name.padEnd(30)} failed: ${err.message}`)
+            regressions.push(`${scenario.name} failed`)
+            continue
+        }
+        results[scenario.name] = result
+
+        const base = baseline[scenario.name]
+        let comparison = 'no baseline'
+        if (base) {
+            comparison = `${percent(result.cpu_us, base.cpu_us)} / ${result.net_bytes - base.net_bytes} / ${result.ram_bytes - base.ram_bytes}`
+            if (result.cpu_us > base.cpu_us * (1 + TOLERANCE)) regressions.push(`${scenario.name} cpu ${percent(result.cpu_us, base.cpu_us)}`)
+            if (result.net_bytes > base.net_bytes) regressions.push(`${scenario.name} net +${result.net_bytes - base.net_bytes}B`)
+            if (result.ram_bytes > base.ram_bytes) regressions.push(`${scenario.name} ram +${result.ram_bytes - base.ram_bytes}B`)
+        }
+        console.log(`${scenario.name.padEnd(30)} ${String(result.cpu_us).padStart(8)} ${String(result.net_bytes).padStart(7)} ${String(result.ram_bytes).padStart(7)}   ${comparison}`)
+    }
+
+    if (args.includes('--update-baseline')) {
+        fs.writeFileSync(BASELINE_FILE, JSON.stringify({ ...baseline, ...results }, null, 4) + '\n')
+        console.log(`baseline written to ${BASELINE_FILE}`)
+    }
+    if (regressions.length) {
+        console.log(`\nregressions:\n  ${regressions.join('\n  ')}`)
+        if (args.includes('--check')) process.exit(1)
+    }
+}
+
+main().catch(err => {
+    console.error(err)
+    process.exit(1)
+})
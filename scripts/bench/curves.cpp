@@ -0,0 +1,101 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief host benchmark of the weight specialized bonding curves (contracts/eos/Common/curves.hpp)
+ *  against the formulas they replaced (`pow` for every weight but the 100% fund / liquidate shortcuts),
+ *  per reserve weight and per formula
+ */
+#include "curves.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace curves;
+
+constexpr size_t TRADES = 1000000;
+constexpr int ROUNDS = 15;
+
+struct trade {
+    double supply;
+    double balance;
+    double amount;
+};
+
+template <typename F>
+double nanoseconds_per_trade(const std::vector<trade>& trades, F&& formula, double& checksum) {
+    double sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const trade& t : trades)
+        sum += formula(t);
+    const auto end = std::chrono::steady_clock::now();
+
+    checksum += sum;
+    return std::chrono::duration<double, std::nano>(end - start).count() / trades.size();
+}
+
+// the pre-specialization formulas, as BancorConverter computed them
+double baseline_purchase(const trade& t, double w) { return -t.supply * (1.0 - pow(1.0 + t.amount / t.balance, w / MAX_WEIGHT)); }
+double baseline_sale(const trade& t, double w) { return t.balance * (1.0 - pow(1.0 - t.amount / t.supply, MAX_WEIGHT / w)); }
+double baseline_fund(const trade& t, double w) {
+    if (w == MAX_WEIGHT) return t.balance * t.amount / t.supply;
+    return t.balance * (pow((t.supply + t.amount) / t.supply, MAX_WEIGHT / w) - 1.0);
+}
+double baseline_liquidate(const trade& t, double w) {
+    if (w == MAX_WEIGHT) return t.amount * t.balance / t.supply;
+    return t.balance * (1.0 - pow((t.supply - t.amount) / t.supply, MAX_WEIGHT / w));
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> supply(1e3, 1e9), balance(1e3, 1e9), share(1e-6, 0.1);
+
+    std::vector<trade> trades(TRADES);
+    for (trade& t : trades) {
+        t.supply = supply(rng);
+        t.balance = balance(rng);
+        t.amount = t.supply * share(rng); // below the supply so it can be sold / liquidated too
+    }
+
+    double checksum = 0;
+    printf("%-10s %-10s %12s %12s %9s %14s\n", "weight", "formula", "baseline ns", "dispatch ns", "speedup", "max rel diff");
+
+    for (const double weight : { 1000000.0, 500000.0, 333333.0, 250000.0 }) {
+        const struct {
+            const char* name;
+            double (*baseline)(const trade&, double);
+            double (*specialized)(const trade&, double);
+        } formulas[] = {
+            { "purchase", baseline_purchase,
+              [](const trade& t, double w) { return purchase_return(t.supply, t.balance, t.amount, w); } },
+            { "sale", baseline_sale,
+              [](const trade& t, double w) { return sale_return(t.supply, t.balance, t.amount, w); } },
+            { "fund", baseline_fund,
+              [](const trade& t, double w) { return fund_cost(t.supply, t.balance, t.amount, w); } },
+            { "liquidate", baseline_liquidate,
+              [](const trade& t, double w) { return liquidate_return(t.supply, t.balance, t.amount, w); } },
+        };
+
+        for (const auto& f : formulas) {
+            // alternate the two loops so that clock and cache drift hits both alike, and keep the best round of each
+            double baseline = 1e18, specialized = 1e18;
+            for (int round = 0; round < ROUNDS; round++) {
+                baseline = fmin(baseline, nanoseconds_per_trade(trades, [&](const trade& t) { return f.baseline(t, weight); }, checksum));
+                specialized = fmin(specialized, nanoseconds_per_trade(trades, [&](const trade& t) { return f.specialized(t, weight); }, checksum));
+            }
+
+            double max_diff = 0;
+            for (const trade& t : trades) {
+                const double expected = f.baseline(t, weight);
+                const double diff = fabs(f.specialized(t, weight) - expected) / expected;
+                if (diff > max_diff) max_diff = diff;
+            }
+            printf("%-10.0f %-10s %12.2f %12.2f %8.2fx %14.3g\n", weight, f.name, baseline, specialized, baseline / specialized, max_diff);
+        }
+    }
+
+    // keeps the compiler from dropping the timed loops
+    fprintf(stderr, "checksum %g\n", checksum);
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * Sustained-throughput load generator for BancorNetwork conversions against a local chain.
+ *
+ * usage (on a chain started with `npm run start`):
+ *   node scripts/bench/load.js [--accounts 20] [--rate 50] [--duration 30] [--mix bnt2eos=50,eos2bnt=40,twohop=10]
+ *
+ * - creates `accounts` load accounts the same way scripts/deploy/test_contracts.sh creates its test users
+ *   (master key, RAM and staked CPU/NET from eosio, BNT and EOS balances), repeated runs reuse them
+ * - pre-signs `rate * duration` conversions of the requested mix, spread round robin over the accounts,
+ *   then pushes them at `rate` transactions per second
+ * - reports the achieved TPS, the failures grouped by class and the push latency percentiles
+ */
+const config = require('../../config/accountNames.json')
+const { api, rpc, createAccountOnChain } = require('../../test/eos/common/utils')
+
+const MASTER_PUB_KEY = 'EOS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV' // scripts/deploy/config/common.conf
+const ACCOUNT_PREFIX = 'bntload'
+
+const master = config.MASTER_ACCOUNT
+const network = config.BANCOR_NETWORK_ACCOUNT
+const converter = config.MULTI_CONVERTER_ACCOUNT
+const bntToken = config.BNT_TOKEN_ACCOUNT
+
+const CONVERSIONS = {
+    bnt2eos: { token: bntToken, quantity: '0.01000000 BNT', path: `${converter}:BNTEOS EOS` },
+    eos2bnt: { token: 'eosio.token', quantity: '0.0100 EOS', path: `${converter}:BNTEOS BNT` },
+    bnt2relay: { token: bntToken, quantity: '0.01000000 BNT', path: `${converter}:BNTEOS BNTEOS` },
+    twohop: { token: 'eosio.token', quantity: '0.0100 EOS', path: `${converter}:BNTEOS BNT ${converter}:BNTEOS BNTEOS` },
+}
+
+const args = process.argv.slice(2)
+const option = (name, fallback) => {
+    const index = args.indexOf(`--${name}`)
+    return index === -1 ? fallback : args[index + 1]
+}
+const ACCOUNTS = Number(option('accounts', 20))
+const RATE = Number(option('rate', 50))
+const DURATION = Number(option('duration', 30))
+const MIX = option('mix', 'bnt2eos=50,eos2bnt=40,twohop=10').split(',').map(entry => {
+    const [name, weight] = entry.split('=')
+    if (!CONVERSIONS[name]) throw new Error(`unknown conversion '${name}', expected one of ${Object.keys(CONVERSIONS)}`)
+    return { name, weight: Number(weight) }
+})
+
+// valid account names only use a-z, 1-5 and '.', so the index is encoded in base 26 letters
+const accountName = index => {
+    let suffix = ''
+    for (let i = 0; i < 5; i++, index = Math.floor(index / 26))
+        suffix = String.fromCharCode(97 + index % 26) + suffix
+    return ACCOUNT_PREFIX + suffix
+}
+
+const transferAction = (token, from, to, quantity, memo) => ({
+    account: token,
+    name: 'transfer',
+    authorization: [{ actor: from, permission: 'active' }],
+    data: { from, to, quantity, memo }
+})
+
+async function setupAccounts() {
+    const accounts = Array.from({ length: ACCOUNTS }, (_, i) => accountName(i))
+    for (const account of accounts) {
+        try {
+            await rpc.get_account(account)
+            continue
+        } catch (err) {}
+
+        await createAccountOnChain(account, MASTER_PUB_KEY)
+        await api.transact({
+            actions: [
+                transferAction(bntToken, master, account, '10.00000000 BNT', 'load test'),
+                transferAction('eosio.token', master, account, '100.0000 EOS', 'load test'),
+            ]
+        }, { blocksBehind: 3, expireSeconds: 30 })
+    }
+    return accounts
+}
+
+// picks the conversion of the i-th transaction so that every `total weight` consecutive transactions follow the mix;
+// stepping by a prime interleaves the conversions instead of sending each one in a burst
+function conversionFor(i) {
+    const total = MIX.reduce((sum, { weight }) => sum + weight, 0)
+    let slot = (total % 37 ? i * 37 : i) % total
+    for (const { name, weight } of MIX) {
+        if (slot < weight) return name
+        slot -= weight
+    }
+}
+
+async function presign(accounts, count) {
+    const transactions = []
+    for (let i = 0; i < count; i++) {
+        const account = accounts[i % accounts.length]
+        const name = conversionFor(i)
+        const { token, quantity, path } = CONVERSIONS[name]
+
+        // the receiver memo keeps otherwise identical transactions from sharing a transaction id
+        const memo = `1,${path},0.00000001,${account};load ${i}`
+        const signed = await api.transact({
+            actions: [transferAction(token, account, network, quantity, memo)]
+        }, { blocksBehind: 3, expireSeconds: 600, broadcast: false, sign: true })
+
+        transactions.push({ name, signed })
+    }
+    return transactions
+}
+
+// groups failures by exception name and assert message, e.g. "eosio_assert_message_exception: below min return"
+function failureClass(err) {
+    const error = err.json && err.json.error
+    if (!error) return err.code || err.type || err.message
+    const assert = (error.details || []).map(({ message }) => message).find(message => /assertion failure/.test(message))
+    return assert ? `${error.name}: ${assert.replace(/.*assertion failure with message: /, '')}` : error.name
+}
+
+const percentile = (sorted, p) => sorted.length ? sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))] : 0
+
+async function run(transactions) {
+    const latencies = []
+    const failures = {}
+    const byConversion = {}
+    const pending = []
+
+    const start = Date.now()
+    for (let i = 0; i < transactions.length; i++) {
+        // send the i-th transaction at start + i / rate
+        const wait = start + i * 1000 / RATE - Date.now()
+        if (wait > 0) await new Promise(resolve => setTimeout(resolve, wait))
+
+        const { name, signed } = transactions[i]
+        const sent = Date.now()
+        byConversion[name] = byConversion[name] || { sent: 0, failed: 0 }
+        byConversion[name].sent++
+
+        pending.push(rpc.push_transaction(signed).then(
+            () => latencies.push(Date.now() - sent),
+            err => {
+                const cls = failureClass(err)
+                failures[cls] = (failures[cls] || 0) + 1
+                byConversion[name].failed++
+            }
+        ))
+    }
+    const sendingTime = (Date.now() - start) / 1000
+    await Promise.all(pending)
+    const elapsed = (Date.now() - start) / 1000
+
+    latencies.sort((a, b) => a - b)
+    console.log(`sent ${transactions.length} transactions in ${sendingTime.toFixed(1)}s (target ${RATE} TPS), all settled after ${elapsed.toFixed(1)}s`)
+    console.log(`achieved: ${(latencies.length / elapsed).toFixed(1)} TPS, ${latencies.length} succeeded, ${transactions.length - latencies.length} failed`)
+    console.log(`latency ms: p50 ${percentile(latencies, 0.5)}, p90 ${percentile(latencies, 0.9)}, p99 ${percentile(latencies, 0.99)}, max ${latencies[latencies.length - 1] || 0}`)
+
+    console.log('\nper conversion:')
+    for (const [name, { sent, failed }] of Object.entries(byConversion))
+        console.log(`  ${name.padEnd(10)} sent ${sent}, failed ${failed}`)
+
+    if (Object.keys(failures).length) {
+        console.log('\nfailure classes:')
+        for (const [cls, count] of Object.entries(failures).sort((a, b) => b[1] - a[1]))
+            console.log(`  ${String(count).padStart(6)}  ${cls}`)
+    }
+}
+
+async function main() {
+    const accounts = await setupAccounts()
+    const count = Math.ceil(RATE * DURATION)
+
+    console.log(`pre-signing ${count} conversions over ${accounts.length} accounts...`)
+    const transactions = await presign(accounts, count)
+    await run(transactions)
+}
+
+main().catch(err => {
+    console.error(err)
+    process.exit(1)
+})
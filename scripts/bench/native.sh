@@ -0,0 +1,19 @@
+#!/bin/bash
+# builds and runs the host benchmarks of the contracts' math, usage: ./scripts/bench/native.sh [benchmark...]
+set -e
+
+GREEN='\033[0;32m'
+NC='\033[0m'
+
+CXX=${CXX:-g++}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+BUILD_DIR=${BUILD_DIR:-/tmp/bancor_bench}
+BENCHMARKS=${@:-$(cd "$ROOT/scripts/bench" && ls *.cpp | sed 's/\.cpp$//')}
+
+mkdir -p $BUILD_DIR
+for bench in $BENCHMARKS
+do
+    echo -e "${GREEN}--> $bench${NC}"
+    $CXX -std=c++17 -O2 -ffp-contract=off -I$ROOT/contracts/eos/Common -I$ROOT/tools $ROOT/scripts/bench/$bench.cpp -o $BUILD_DIR/$bench -lpthread
+    $BUILD_DIR/$bench
+done
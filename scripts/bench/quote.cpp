@@ -0,0 +1,75 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief host benchmark of the batch quote kernels (tools/quote/batch_quote.hpp) against a scalar loop
+ *  over the contract formulas, for a batch of candidate trade sizes on one pool
+ */
+#include "quote/batch_quote.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+constexpr size_t AMOUNTS = 4096;
+constexpr int ROUNDS = 200;
+
+template <typename F>
+double nanoseconds_per_quote(F&& quote) {
+    double best = 1e18;
+    for (int round = 0; round < ROUNDS; round++) {
+        const auto start = std::chrono::steady_clock::now();
+        quote();
+        const auto end = std::chrono::steady_clock::now();
+
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / AMOUNTS;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+int main() {
+    if (!batch_quote::avx2::supported()) {
+        printf("AVX2/FMA not supported, batch quotes use the scalar fallback\n");
+        return 0;
+    }
+
+    const double supply = 2500000.0, balance = 1800000.0, to_balance = 950000.0;
+    const double fee_1 = batch_quote::fee_rate(2500, 1), fee_2 = batch_quote::fee_rate(2500, 2);
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> share(1e-6, 0.05);
+    std::vector<double> amounts(AMOUNTS), scalar(AMOUNTS), simd(AMOUNTS);
+    for (double& amount : amounts)
+        amount = supply * share(rng);
+
+    printf("%-10s %-10s %12s %12s %9s %14s\n", "weights", "formula", "scalar ns", "avx2 ns", "speedup", "max rel diff");
+
+    const auto report = [&](const char* weights, const char* formula, auto&& scalar_quote, auto&& simd_quote) {
+        const double scalar_ns = nanoseconds_per_quote(scalar_quote);
+        const double simd_ns = nanoseconds_per_quote(simd_quote);
+
+        double max_diff = 0;
+        for (size_t i = 0; i < AMOUNTS; i++) {
+            const double diff = fabs(simd[i] - scalar[i]) / scalar[i];
+            if (diff > max_diff) max_diff = diff;
+        }
+        printf("%-10s %-10s %12.2f %12.2f %8.2fx %14.3g\n", weights, formula, scalar_ns, simd_ns, scalar_ns / simd_ns, max_diff);
+    };
+
+    for (const double weight : { 500000.0, 250000.0, 400000.0 }) {
+        char weights[16];
+        snprintf(weights, sizeof(weights), "%.0f", weight);
+
+        report(weights, "purchase",
+            [&] { batch_quote::scalar::purchase_returns(amounts.data(), scalar.data(), AMOUNTS, supply, balance, weight, fee_1); },
+            [&] { batch_quote::avx2::purchase_returns(amounts.data(), simd.data(), AMOUNTS, supply, balance, weight, fee_1); });
+        report(weights, "sale",
+            [&] { batch_quote::scalar::sale_returns(amounts.data(), scalar.data(), AMOUNTS, supply, balance, weight, fee_1); },
+            [&] { batch_quote::avx2::sale_returns(amounts.data(), simd.data(), AMOUNTS, supply, balance, weight, fee_1); });
+        report(weights, "cross",
+            [&] { batch_quote::scalar::cross_reserve_returns(amounts.data(), scalar.data(), AMOUNTS, balance, weight, to_balance, 1000000.0 - weight, fee_2); },
+            [&] { batch_quote::avx2::cross_reserve_returns(amounts.data(), simd.data(), AMOUNTS, balance, weight, to_balance, 1000000.0 - weight, fee_2); });
+    }
+    return 0;
+}
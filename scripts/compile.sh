@@ -1,7 +1,7 @@
 #!/bin/bash
 eosiocpp() {
     COMMAND="eosio-cpp $*"
-    docker run --rm --name eosio.cdt_v1.7.0 -v $HOME/git/contracts_eos:/project eostudio/eosio.cdt:v1.7.0 /bin/bash -c "$COMMAND"
+    docker run --rm --name eosio.cdt_v1.8.1 -v $HOME/git/contracts_eos:/project eostudio/eosio.cdt:v1.8.1 /bin/bash -c "$COMMAND"
 }
 
 PROJECT_PATH=./project
@@ -94,6 +94,15 @@ ensureaccount $MULTI_STAKING_ACCOUNT $MASTER_PUB_KEY
 
 echo -e "${CYAN}-----------------------DEPLOYING CONTRACTS-----------------------${NC}"
 
+# the converter returns its conversion results, so its code can only be set on a chain with ACTION_RETURN_VALUE activated
+ACTION_RETURN_VALUE="c3a6138c5061cf291310887c0b5c71fcaffeab90d5deb50d3b9e687cead45071"
+ACTIVATED=$(curl -s -X POST ${NODEOS_ENDPOINT}/v1/chain/get_activated_protocol_features -d '{"limit": 1000}' | jq '[.activated_protocol_features[].feature_digest] | index("'$ACTION_RETURN_VALUE'")')
+if [ "$ACTIVATED" == "null" ] || [ -z "$ACTIVATED" ] ; then
+  echo "the ACTION_RETURN_VALUE protocol feature ($ACTION_RETURN_VALUE) must be activated before deploying the converter (see scripts/deploy/system_contracts.sh)"
+  on_exit
+  exit 1
+fi
+
 cleos set contract $TX_REROUTER_ACCOUNT $MY_CONTRACTS_BUILD/eos/XTransferRerouter
 cleos set contract $BANCOR_NETWORK_ACCOUNT $MY_CONTRACTS_BUILD/eos/BancorNetwork
 cleos set contract $BANCOR_X_ACCOUNT $MY_CONTRACTS_BUILD/eos/BancorX
@@ -126,6 +135,8 @@ if (($ROWS==0)) ; then # BancorX
   cleos push action $BANCOR_X_ACCOUNT addreporter '["'$REPORTER_1_ACCOUNT'"]' -p $BANCOR_X_ACCOUNT
   cleos push action $BANCOR_X_ACCOUNT addreporter '["'$REPORTER_2_ACCOUNT'"]' -p $BANCOR_X_ACCOUNT
   cleos push action $BANCOR_X_ACCOUNT addreporter '["'$REPORTER_3_ACCOUNT'"]' -p $BANCOR_X_ACCOUNT
+  cleos push action $BANCOR_X_ACCOUNT addchain '["eth"]' -p $BANCOR_X_ACCOUNT
+  cleos push action $BANCOR_X_ACCOUNT addchain '["eos2"]' -p $BANCOR_X_ACCOUNT
 fi
 
 ROWS=$(cleos get table $MULTI_CONVERTER_ACCOUNT $MULTI_CONVERTER_ACCOUNT settings | jq .rows | jq length)
@@ -161,6 +172,11 @@ ROWS=$(cleos get table $BANCOR_NETWORK_ACCOUNT $BANCOR_NETWORK_ACCOUNT settings
 if (($ROWS==0)) ; then # BancorNetwork
   cleos push action $BANCOR_NETWORK_ACCOUNT setmaxfee '["30000"]' -p $BANCOR_NETWORK_ACCOUNT
   cleos push action $BANCOR_NETWORK_ACCOUNT setnettoken '["'$BNT_TOKEN_ACCOUNT'"]' -p $BANCOR_NETWORK_ACCOUNT
+  cleos push action $BANCOR_NETWORK_ACCOUNT regconverter '["'$MULTI_CONVERTER_ACCOUNT'", "BNTEOS"]' -p $BANCOR_NETWORK_ACCOUNT
+  # the pools created by the converter tests
+  for SMART_TOKEN in TKNA TKNB RELAY RELAYB; do
+    cleos push action $BANCOR_NETWORK_ACCOUNT regconverter '["'$MULTI_CONVERTER_ACCOUNT'", "'$SMART_TOKEN'"]' -p $BANCOR_NETWORK_ACCOUNT
+  done
 fi
 
 on_exit
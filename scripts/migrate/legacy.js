@@ -0,0 +1,273 @@
+/**
+ * Migrates single pool legacy/BancorConverter deployments into the multi-converter.
+ *
+ * usage:
+ *   node scripts/migrate/legacy.js --converters bnt2syscnvrt,bnt2aaacnvrt [--owner bnttestuser1] [--dry-run] [--snapshot snapshot.json]
+ *   node scripts/migrate/legacy.js --converters bnt2syscnvrt --distribute [--transfers 50] [--dry-run]
+ *
+ * for every legacy converter:
+ * - snapshots its settings, its reserves, the real reserve balances (token contracts' `accounts`) and the smart token supply
+ * - plans the matching multi-converter with `create` semantics (same smart token code, the legacy supply as initial supply,
+ *   owned by the legacy converter account), the legacy fee and a `setreserve` per reserve with the same weight
+ * - moves the whole reserve balances with `fund;<symbol>` transfers, which go straight into the reserves of an inactive converter
+ *
+ * every converter is migrated in its own transaction, so it migrates completely or not at all and a failing converter
+ * doesn't hold back the others; the legacy converter is disabled in the same transaction and the new one is handed over
+ * to `owner` (if given)
+ *
+ * the new smart tokens are issued to the legacy converter account, which then swaps them 1:1 (rounded down to the
+ * multi-token precision) for the legacy smart tokens of every holder, in transactions of `transfers` transfers;
+ * the legacy converter is disabled by then, so the holders are read after the migration and can't change anymore.
+ * A holder that already has a balance of the new smart token is skipped and reported, so an interrupted swap can be
+ * resumed with `--distribute`, which only swaps the holders of converters that were already migrated.
+ * `--dry-run` only prints the report (snapshot, planned actions, warnings, blockers, or the planned swaps with `--distribute`);
+ * converters with blockers are skipped
+ */
+const fs = require('fs')
+const config = require('../../config/accountNames.json')
+const { api, rpc, getTableBoundsForSymbol } = require('../../test/eos/common/utils')
+
+const multiConverter = config.MULTI_CONVERTER_ACCOUNT
+
+const MULTI_TOKEN_PRECISION = 4 // BancorConverter::DEFAULT_TOKEN_PRECISION
+const MULTI_MAX_SUPPLY = 10000000000 // BancorConverter::DEFAULT_MAX_SUPPLY
+const MAX_INITIAL_MAXIMUM_SUPPLY_RATIO = 0.1
+
+const args = process.argv.slice(2)
+const option = (name, fallback) => {
+    const index = args.indexOf(`--${name}`)
+    return index === -1 ? fallback : args[index + 1]
+}
+const CONVERTERS = option('converters', '').split(',').filter(Boolean)
+const OWNER = option('owner', '')
+const TRANSFERS = Number(option('transfers', 50))
+const DISTRIBUTE = args.includes('--distribute')
+const SNAPSHOT_FILE = option('snapshot', '')
+const DRY_RUN = args.includes('--dry-run')
+
+const parseAsset = quantity => {
+    const [amount, symbol] = quantity.split(' ')
+    const [, decimals = ''] = amount.split('.')
+    return { amount: Number(amount), symbol, precision: decimals.length }
+}
+
+const formatAsset = (amount, symbol, precision) => `${amount.toFixed(precision)} ${symbol}`
+
+const action = (account, name, actor, data) => ({
+    account,
+    name,
+    authorization: [{ actor, permission: 'active' }],
+    data
+})
+
+const tableRows = (code, scope, table, bounds = {}) =>
+    rpc.get_table_rows({ code, scope, table, limit: 100, ...bounds }).then(({ rows }) => rows)
+
+async function snapshot(converter) {
+    const [settings] = await tableRows(converter, converter, 'settings')
+    if (!settings) return { converter, settings: null, reserves: [] }
+
+    const smart = parseAsset(settings.smart_currency)
+    const [stat] = await tableRows(settings.smart_contract, smart.symbol, 'stat')
+    const reserves = await Promise.all((await tableRows(converter, converter, 'reserves')).map(async reserve => {
+        const { symbol, precision } = parseAsset(reserve.currency)
+        const [account] = await tableRows(reserve.contract, converter, 'accounts', getTableBoundsForSymbol(symbol, false))
+        return { ...reserve, symbol, precision, real_balance: account ? account.balance : formatAsset(0, symbol, precision) }
+    }))
+
+    return { converter, settings, supply: stat ? stat.supply : null, reserves }
+}
+
+async function plan({ converter, settings, supply, reserves }, multiSettings) {
+    const blockers = [], warnings = [], actions = []
+    if (!settings) return { converter, blockers: ['legacy settings not found'], warnings, actions }
+
+    const smart = parseAsset(settings.smart_currency)
+    if (!supply) blockers.push(`smart token ${smart.symbol} not found on ${settings.smart_contract}`)
+    if (!reserves.length) blockers.push('converter has no reserves')
+
+    // an existing converter or multi-token symbol with the same code
+    const [existing] = await tableRows(multiConverter, multiConverter, 'converters', getTableBoundsForSymbol(smart.symbol, false))
+    if (existing) blockers.push(`multi-converter already has a ${smart.symbol} converter`)
+    const [existingStat] = await tableRows(multiSettings.multi_token, smart.symbol, 'stat')
+    if (existingStat) blockers.push(`${multiSettings.multi_token} already has a ${smart.symbol} token`)
+
+    // the legacy virtual balances are offsets the multi-converter has no equivalent for
+    if (smart.amount) blockers.push(`virtual smart supply ${settings.smart_currency}`)
+    for (const reserve of reserves) {
+        if (parseAsset(reserve.currency).amount) blockers.push(`virtual ${reserve.symbol} balance ${reserve.currency}`)
+        if (!parseAsset(reserve.real_balance).amount) blockers.push(`empty ${reserve.symbol} reserve, the converter couldn't be activated`)
+        if (!reserve.sale_enabled) warnings.push(`purchases of ${reserve.symbol} are disabled in the legacy converter, they will be enabled`)
+        if (reserve.balance && reserve.balance !== reserve.real_balance)
+            warnings.push(`kept ${reserve.symbol} balance ${reserve.balance} differs from the real balance ${reserve.real_balance}, the real balance is moved`)
+    }
+    if (reserves.reduce((sum, { ratio }) => sum + ratio, 0) > 1000000) blockers.push('total reserve ratio exceeds 100%')
+    if (settings.fee > multiSettings.max_fee) blockers.push(`fee ${settings.fee} exceeds the multi-converter maximum fee ${multiSettings.max_fee}`)
+    if (!settings.enabled) warnings.push('legacy converter is disabled, the new converter will be enabled')
+
+    let initialSupply = 0
+    if (supply) {
+        const { amount, precision } = parseAsset(supply)
+        initialSupply = Number(amount.toFixed(MULTI_TOKEN_PRECISION))
+        if (precision > MULTI_TOKEN_PRECISION && initialSupply !== amount)
+            warnings.push(`smart token supply ${supply} is rounded to ${formatAsset(initialSupply, smart.symbol, MULTI_TOKEN_PRECISION)}`)
+        if (initialSupply <= 0) blockers.push('empty smart token supply')
+        if (initialSupply / MULTI_MAX_SUPPLY > MAX_INITIAL_MAXIMUM_SUPPLY_RATIO) blockers.push(`smart token supply ${supply} is too big for the multi-converter`)
+    }
+
+    // create --> fee --> reserves --> fund every reserve --> disable the legacy converter --> hand over
+    actions.push(action(multiConverter, 'create', converter, { owner: converter, token_code: smart.symbol, initial_supply: initialSupply }))
+    if (settings.fee)
+        actions.push(action(multiConverter, 'updatefee', converter, { currency: smart.symbol, fee: settings.fee }))
+    for (const reserve of reserves)
+        actions.push(action(multiConverter, 'setreserve', converter, {
+            converter_currency_code: smart.symbol,
+            currency: `${reserve.precision},${reserve.symbol}`,
+            contract: reserve.contract,
+            ratio: reserve.ratio
+        }))
+    for (const reserve of reserves)
+        actions.push(action(reserve.contract, 'transfer', converter, {
+            from: converter,
+            to: multiConverter,
+            quantity: reserve.real_balance,
+            memo: `fund;${smart.symbol}`
+        }))
+    actions.push(action(converter, 'update', converter, {
+        smart_enabled: false,
+        enabled: false,
+        require_balance: settings.require_balance,
+        fee: settings.fee
+    }))
+    if (OWNER && OWNER !== converter)
+        actions.push(action(multiConverter, 'updateowner', converter, { currency: smart.symbol, new_owner: OWNER }))
+
+    return { converter, symbol: smart.symbol, blockers, warnings, actions }
+}
+
+// every account holding the legacy smart token, except the legacy converter itself
+async function holders({ converter, settings }) {
+    const smart = parseAsset(settings.smart_currency)
+    const result = []
+    let lower_bound = ''
+    do {
+        const { rows, more } = await rpc.get_table_by_scope({ code: settings.smart_contract, table: 'accounts', lower_bound, limit: 100 })
+        for (const { scope } of rows) {
+            if (scope === converter) continue
+            const [account] = await tableRows(settings.smart_contract, scope, 'accounts', getTableBoundsForSymbol(smart.symbol, false))
+            if (account && parseAsset(account.balance).amount) result.push({ holder: scope, balance: account.balance })
+        }
+        lower_bound = more
+    } while (lower_bound)
+    return result
+}
+
+// transfers of the new smart token from the legacy converter to every legacy holder that wasn't paid yet
+async function planSwaps(legacy, multiSettings) {
+    const { converter } = legacy
+    const smart = parseAsset(legacy.settings.smart_currency)
+    const transfers = [], skipped = []
+    for (const { holder, balance } of await holders(legacy)) {
+        const [paid] = await tableRows(multiSettings.multi_token, holder, 'accounts', getTableBoundsForSymbol(smart.symbol, false))
+        if (paid) {
+            skipped.push(`${holder} holds ${balance} but already has ${paid.balance}, swap it manually if it wasn't paid`)
+            continue
+        }
+        const scale = Math.pow(10, MULTI_TOKEN_PRECISION)
+        const amount = Math.floor(parseAsset(balance).amount * scale) / scale
+        if (!amount) continue
+        transfers.push(action(multiSettings.multi_token, 'transfer', converter, {
+            from: converter,
+            to: holder,
+            quantity: formatAsset(amount, smart.symbol, MULTI_TOKEN_PRECISION),
+            memo: `${smart.symbol} migrated to ${multiConverter}`
+        }))
+    }
+    return { transfers, skipped }
+}
+
+async function swap(legacy, multiSettings) {
+    const { transfers, skipped } = await planSwaps(legacy, multiSettings)
+    for (const warning of skipped) console.log(`  warning       ${warning}`)
+    console.log(`${legacy.converter}: ${transfers.length} holders to swap`)
+    if (DRY_RUN) {
+        for (const { data } of transfers) console.log(`  swap          ${data.quantity} --> ${data.to}`)
+        return
+    }
+
+    for (let i = 0; i < transfers.length; i += TRANSFERS) {
+        const chunk = transfers.slice(i, i + TRANSFERS)
+        const result = await api.transact({ actions: chunk }, { blocksBehind: 3, expireSeconds: 30 })
+        console.log(`swapped ${chunk.length} holders of ${legacy.converter} in ${result.transaction_id}`)
+    }
+}
+
+function report(snapshots, plans) {
+    for (const [i, { converter, symbol, blockers, warnings, actions }] of plans.entries()) {
+        const { settings, supply, reserves } = snapshots[i]
+        console.log(`\n${converter}${symbol ? ` --> ${multiConverter}:${symbol}` : ''}`)
+        if (settings) {
+            console.log(`  smart token   ${supply} (${settings.smart_contract}), fee ${settings.fee}`)
+            for (const reserve of reserves)
+                console.log(`  reserve       ${reserve.real_balance.padEnd(28)} ${reserve.contract.padEnd(13)} ratio ${reserve.ratio}`)
+        }
+        for (const warning of warnings) console.log(`  warning       ${warning}`)
+        for (const blocker of blockers) console.log(`  BLOCKER       ${blocker}`)
+        if (!blockers.length)
+            for (const { account, name, data } of actions)
+                console.log(`  action        ${account}::${name} ${JSON.stringify(data)}`)
+    }
+}
+
+async function main() {
+    if (!CONVERTERS.length) throw new Error('no legacy converters given, use --converters account1,account2')
+
+    const [multiSettings] = await tableRows(multiConverter, multiConverter, 'settings')
+    if (!multiSettings) throw new Error(`${multiConverter} settings not found`)
+
+    const snapshots = []
+    for (const converter of CONVERTERS) snapshots.push(await snapshot(converter))
+    if (SNAPSHOT_FILE) fs.writeFileSync(SNAPSHOT_FILE, JSON.stringify(snapshots, null, 4) + '\n')
+
+    if (DISTRIBUTE) {
+        for (const legacy of snapshots) {
+            if (!legacy.settings) {
+                console.log(`${legacy.converter}: legacy settings not found`)
+                continue
+            }
+            const { symbol } = parseAsset(legacy.settings.smart_currency)
+            const [migrated] = await tableRows(multiConverter, multiConverter, 'converters', getTableBoundsForSymbol(symbol, false))
+            if (legacy.settings.enabled || !migrated) {
+                console.log(`${legacy.converter}: not migrated yet`)
+                continue
+            }
+            await swap(legacy, multiSettings).catch(err => console.log(`failed to swap the holders of ${legacy.converter}: ${err.message}`))
+        }
+        return
+    }
+
+    const plans = []
+    for (const legacy of snapshots) plans.push(await plan(legacy, multiSettings))
+    report(snapshots, plans)
+
+    const ready = plans.filter(({ blockers }) => !blockers.length)
+    console.log(`\n${ready.length} of ${plans.length} converters ready to migrate`)
+    if (DRY_RUN || !ready.length) return
+
+    for (const { converter, actions } of ready) {
+        try {
+            const result = await api.transact({ actions }, { blocksBehind: 3, expireSeconds: 30 })
+            console.log(`migrated ${converter} in ${result.transaction_id}`)
+        } catch (err) {
+            console.log(`failed to migrate ${converter}: ${err.message}`)
+            continue
+        }
+        await swap(snapshots.find(legacy => legacy.converter === converter), multiSettings)
+            .catch(err => console.log(`failed to swap the holders of ${converter}, resume with --distribute: ${err.message}`))
+    }
+}
+
+main().catch(err => {
+    console.error(err)
+    process.exit(1)
+})
@@ -19,7 +19,9 @@ const {
     update,
     enablerpt,
     addreporter,
-    rmreporter
+    rmreporter,
+    addchain,
+    rmchain
 } = require('./common/bancor-x');
 const { ERRORS } = require('./common/errors');
 
@@ -82,6 +84,69 @@ describe('BancorX', () => {
     });
 
 
+    it('ensures xTransfer only consumes from the destination blockchain\'s limit bucket', async function() {
+        const quantity = `${randomAmount({ min: 1, max: 2 })} ${networkTokenSymbol}`;
+        await expectNoError(
+            transfer(networkToken, quantity, bancorXContract, testUser, '1.1,eos2,ETH_ADDRESS')
+        );
+
+        const buckets = (await getTableRows(bancorXContract, 'destroy', 'buckets')).rows;
+        const eos2Bucket = buckets.find(({ key }) => key === 'eos2');
+        const ethBucket = buckets.find(({ key }) => key === 'eth');
+
+        assert.notEqual(eos2Bucket, undefined);
+        assert.notEqual(ethBucket, undefined);
+        Number(eos2Bucket.prev_limit).should.be.above(Number(ethBucket.prev_limit));
+    });
+
+    it('ensures a destroy bucket refills after being consumed from', async function() {
+        const bucket = async () => (await getTableRows(bancorXContract, 'destroy', 'buckets')).rows.find(({ key }) => key === 'eos2');
+        const max = Number((await getTableRows(bancorXContract, bancorXContract, 'settings')).rows[0].max_destroy_limit);
+
+        await expectNoError(
+            transfer(networkToken, `2.00000000 ${networkTokenSymbol}`, bancorXContract, testUser, '1.1,eos2,ETH_ADDRESS')
+        );
+        await snooze(1500) // limit_inc refills 2 BNT within a second
+        await expectNoError(
+            transfer(networkToken, `1.00000000 ${networkTokenSymbol}`, bancorXContract, testUser, '1.1,eos2,ETH_ADDRESS')
+        );
+        Number((await bucket()).prev_limit).should.be.equal(max - 100000000);
+    });
+
+    it('should throw when transferring from or to an unsupported blockchain', async function() {
+        await expectError(
+            transfer(networkToken, `2.00000000 ${networkTokenSymbol}`, bancorXContract, testUser, '1.1,eos3,ETH_ADDRESS'),
+            ERRORS.UNSUPPORTED_BLOCKCHAIN
+        );
+        await expectError(
+            reporttx({ tx_id: Math.floor(100000 + Math.random() * 900000), reporter: reporter1User, blockchain: 'eos3' }),
+            ERRORS.UNSUPPORTED_BLOCKCHAIN
+        );
+        const buckets = (await getTableRows(bancorXContract, 'destroy', 'buckets')).rows;
+        assert.equal(buckets.find(({ key }) => key === 'eos3'), undefined);
+    });
+
+    it('ensures only the contract may add and remove supported blockchains', async function() {
+        await expectError(addchain('eos3', testUser), ERRORS.PERMISSIONS);
+        await expectError(addchain('eth'), ERRORS.BLOCKCHAIN_ALREADY_SUPPORTED);
+
+        await expectNoError(addchain('eos3'));
+        try {
+            const bucket = (await getTableRows(bancorXContract, 'issue', 'buckets')).rows.find(({ key }) => key === 'eos3');
+            assert.notEqual(bucket, undefined);
+
+            // the new bucket starts from the limit all blockchains shared, untouched since the deploy added its chains
+            const settings = (await getTableRows(bancorXContract, bancorXContract, 'settings')).rows[0];
+            Number(settings.prev_issue_limit).should.be.equal(Number(settings.max_issue_limit));
+            Number(bucket.prev_limit).should.be.equal(Number(settings.prev_issue_limit));
+            await expectError(rmchain('eos3', testUser), ERRORS.PERMISSIONS);
+        }
+        finally {
+            await expectNoError(rmchain('eos3'));
+        }
+        await expectError(rmchain('eos3'), ERRORS.UNSUPPORTED_BLOCKCHAIN);
+    });
+
     it('ensures reporttx creates a valid transfer document, and releases funds once all reporters report', async () => {
         const transferId = Math.floor(100000 + Math.random() * 900000)
         const amount = randomAmount({});
@@ -118,6 +183,44 @@ describe('BancorX', () => {
         finalBalance.toFixed(8).should.be.equal((initialBalance + Number(amount)).toFixed(8));
     });
 
+    it('ensures the garbage collection resumes from its cursor and keeps unexpired transfers', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+        const gcState = async () => (await getTableRows(bancorXContract, bancorXContract, 'gcstate')).rows[0];
+        const before = await gcState();
+
+        await expectNoError(
+            reporttx({ tx_id: transferId, reporter: reporter1User })
+        );
+
+        // nothing expired yet, the sweep visited 2 rows from the previous cursor and stopped before the next one
+        const pending = (await getTableRows(bancorXContract, bancorXContract, 'transfers', null, 1000)).rows;
+        pending.map(({ tx_id }) => tx_id).should.include(transferId);
+        pending.forEach(({ timestamp }) => assert.notEqual(timestamp, null));
+
+        const keys = pending.map(({ tx_id }) => Number(tx_id)).filter(id => id >= Number(before ? before.transfers_cursor : 0));
+        Number((await gcState()).transfers_cursor).should.be.equal(keys.length > 2 ? keys[2] : 0);
+    });
+
+    it('should throw when an already issued x_transfer_id is reported again', async () => {
+        const xTransferId = Math.floor(100000 + Math.random() * 900000)
+        for (const reporter of [reporter1User, reporter2User])
+            await expectNoError(
+                reporttx({ tx_id: xTransferId, reporter, x_transfer_id: xTransferId })
+            );
+
+        const amount = (await getTableRows(bancorXContract, bancorXContract, 'amounts', null, 1000)).rows
+            .find(({ x_transfer_id }) => x_transfer_id === xTransferId);
+        assert.notEqual(amount, undefined);
+
+        await expectNoError(
+            reporttx({ tx_id: xTransferId + 1, reporter: reporter1User, x_transfer_id: xTransferId })
+        );
+        await expectError(
+            reporttx({ tx_id: xTransferId + 1, reporter: reporter2User, x_transfer_id: xTransferId }),
+            'x_transfer_id already exists'
+        );
+    });
+
     it('ensures no event is emitted when to xTransfer using an unknown token', async function() {
         const quantity = `${randomAmount({ decimals: 4 })} EOS`;
         const res = await expectNoError(
@@ -8,13 +8,15 @@ const {
     expectNoError,
     randomAmount,
     extractEvents,
+    getTableRows,
     calculatePurchaseReturn,
     calculateSaleReturn,
     calculateQuickConvertReturn,
     calculateFundCost,
     calculateLiquidateReturn,
     toFixedRoundUp,
-    toFixedRoundDown
+    toFixedRoundDown,
+    snooze
 } = require('./common/utils')
 
 const {
@@ -40,9 +42,19 @@ const {
     enableStake,
     updateOwner,
     updateFee,
+    setEvents,
     setMaxfee,
     withdraw,
-    fund
+    fund,
+    migrate,
+    clearTables,
+    getMigration,
+    getState,
+    getTwap,
+    getOracle,
+    activate,
+    settle,
+    getOrders
 } = require('./common/converter')
 
 const { ERRORS } = require('./common/errors')
@@ -54,6 +66,12 @@ const user2 = config.TEST_ACCOUNT
 const multiToken = config.MULTI_TOKEN_ACCOUNT
 const bancorConverter = config.MULTI_CONVERTER_ACCOUNT
 
+// data of the `log` inline actions of a trace
+const logActions = trace => [
+    ...(trace.act.name === 'log' ? [trace.act.data] : []),
+    ...(trace.inline_traces || []).flatMap(logActions)
+]
+
 describe('BancorConverter', () => {
     describe('setup', async () => {
         it('setup converters', async function() {
@@ -842,6 +860,362 @@ describe('BancorConverter', () => {
             const expectedSmartSupply = parseFloat(res.rows[0].supply.split(' ')[0])
             assert.equal(expectedSmartSupply, parseFloat(fromTokenPriceDataEvent.smart_supply).toFixed(4), 'unexpected smart supply');
         });
+        it('[setevents] only the converter owner may set a valid events mode', async function() {
+            await expectError(
+                setEvents(user2, 'BNTEOS', 'conversion'),
+                ERRORS.PERMISSIONS
+            )
+            await expectError(
+                setEvents(user1, 'BNTEOS', 'verbose'),
+                'invalid events mode'
+            )
+            await expectError(
+                setEvents(user1, 'BNTEOS', 'threshold', 0),
+                'threshold must be between 1 and 1000000'
+            )
+            await expectError(
+                setEvents(user1, 'BNTEOS', 'full', 100),
+                'threshold is only used in threshold mode'
+            )
+        });
+        it('[setevents] price data events follow the events mode', async function() {
+            const priceDataEvents = result => logActions(result.processed.action_traces[0]).filter(({ event }) => event === 'price_data')
+            const convertRandom = () => expectNoError(convertBNT(randomAmount({min: 1, max: 5, decimals: 8 })))
+
+            // one event per conversion, for the reserve it changed last
+            await expectNoError(setEvents(user1, 'BNTEOS', 'conversion'))
+            assert.equal(priceDataEvents(await convertRandom()).length, 1, 'missing price_data event in conversion mode')
+            const crossReserveEvents = priceDataEvents(await expectNoError(
+                convertBNT(randomAmount({min: 1, max: 5, decimals: 8 }), 'EOS', `${bancorConverter}:BNTEOS`)
+            ))
+            assert.equal(crossReserveEvents.length, 1, 'unexpected price_data events for a reserve --> reserve conversion')
+            assert.equal(crossReserveEvents[0].data.find(({ key }) => key === 'reserve_symbol').value, 'EOS', 'unexpected price_data reserve in conversion mode')
+
+            // the first change of a reserve is always logged, a 100% threshold skips the next small ones
+            await expectNoError(setEvents(user1, 'BNTEOS', 'threshold', 1000000))
+            assert.equal(priceDataEvents(await convertRandom()).length, 1, 'missing first price_data event in threshold mode')
+            assert.equal(priceDataEvents(await convertRandom()).length, 0, 'unexpected price_data event below the threshold')
+
+            await expectNoError(setEvents(user1, 'BNTEOS', 'full'))
+            assert.equal(priceDataEvents(await convertRandom()).length, 1, 'missing price_data event in full mode')
+        });
+    });
+
+    describe('Payouts', async () => {
+        // the traces of an action and of every inline action it sent
+        const traces = trace => [trace, ...(trace.inline_traces || []).flatMap(traces)]
+        const networkBalance = async () => {
+            const { rows: [account] } = await getBalance(bancorNetwork, 'eosio.token', 'EOS')
+            return account ? account.balance : '0.0000 EOS'
+        }
+
+        it('[convert] pays the final hop to the destination directly from the converter', async () => {
+            const initialNetworkBalance = await networkBalance()
+
+            const result = await expectNoError(
+                transfer(bntToken, '1.00000000 BNT', bancorNetwork, user1, `1,${bancorConverter}:BNTEOS EOS,0.0001,${user2};direct payout`)
+            )
+            const payouts = traces(result.processed.action_traces[0]).filter(({ receiver, act }) =>
+                receiver === 'eosio.token' && act.name === 'transfer' && act.data.to === user2
+            )
+            assert.equal(payouts.length, 1, 'destination not paid once')
+            assert.equal(payouts[0].act.data.from, bancorConverter, 'destination not paid by the converter')
+            assert.equal(payouts[0].act.data.memo, 'direct payout', 'receiver memo not forwarded')
+
+            assert.equal(await networkBalance(), initialNetworkBalance, 'return passed through the network')
+        });
+    });
+
+    describe('Versions', async () => {
+        const getConverter = async currency => (await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000))
+            .rows.find(row => row.currency.split(',')[1] === currency)
+        const getVersion = async currency => Number((await getConverter(currency)).version)
+
+        it('[version] bumps on every conversion through the converter', async () => {
+            const initialVersion = await getVersion('BNTEOS')
+            await expectNoError(convertBNT(randomAmount({min: 1, max: 5, decimals: 8 })))
+            assert.isAbove(await getVersion('BNTEOS'), initialVersion, 'version not bumped by a conversion')
+        });
+        it('[version] bumps once on a fee change, not on an unchanged fee', async () => {
+            const { fee } = await getConverter('BNTEOS')
+            const initialVersion = await getVersion('BNTEOS')
+
+            await expectNoError(updateFee(user1, 'BNTEOS', Number(fee) + 1))
+            assert.equal(await getVersion('BNTEOS'), initialVersion + 1, 'version not bumped by a fee change')
+
+            await expectNoError(updateFee(user1, 'BNTEOS', Number(fee) + 1))
+            assert.equal(await getVersion('BNTEOS'), initialVersion + 1, 'version bumped without a change')
+
+            await expectNoError(updateFee(user1, 'BNTEOS', fee))
+        });
+    });
+
+    describe('Supply', async () => {
+        const mirroredSupply = async currency => (await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000))
+            .rows.find(row => row.currency.split(',')[1] === currency).supply
+        const tokenSupply = async currency => (await get(multiToken, currency)).rows[0].supply
+        const assertMirrored = async step =>
+            assert.equal(await mirroredSupply('BNTEOS'), await tokenSupply('BNTEOS'), `supply not mirrored after ${step}`)
+
+        it('[supply] mirrors the smart token supply through fund, liquidate and conversions', async () => {
+            await assertMirrored('the previous tests')
+
+            await expectNoError(transfer(bntToken, '10.00000000 BNT', bancorConverter, user1, 'fund;BNTEOS'))
+            await expectNoError(transfer('eosio.token', '10.0000 EOS', bancorConverter, user1, 'fund;BNTEOS'))
+            await expectNoError(fund(user1, '1.0000 BNTEOS'))
+            await assertMirrored('fund')
+
+            await expectNoError(transfer(multiToken, '1.0000 BNTEOS', bancorConverter, user1, 'liquidate'))
+            await assertMirrored('liquidate')
+
+            await expectNoError(convertBNT('1.00000000'))
+            await assertMirrored('a reserve --> smart conversion')
+
+            await expectNoError(convert('1.0000 BNTEOS', multiToken, [`${bancorConverter}:BNTEOS BNT`]))
+            await assertMirrored('a smart --> reserve conversion')
+
+            // leave no temporary balances behind
+            for (const symbol of ['BNT', 'EOS']) {
+                const { rows: [account] } = await getAccount(user1, 'BNTEOS', symbol)
+                if (account) await expectNoError(withdraw(user1, account.quantity, 'BNTEOS'))
+            }
+        });
+    });
+
+    describe('State', async () => {
+        const statePage = result => result.processed.action_traces[0].return_value_data
+
+        it('[getstate] ensures a valid limit and fields', async () => {
+            await expectError(
+                getState(0, 0),
+                'limit must be between 1 and 500'
+            )
+            await expectError(
+                getState(0, 501),
+                'limit must be between 1 and 500'
+            )
+            await expectError(
+                getState(0, 10, ['owner']),
+                'invalid state field'
+            )
+        });
+        it('[getstate] pages through every converter, with the requested fields only', async () => {
+            const { rows } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+
+            const converters = []
+            let cursor = 0
+            do {
+                const page = statePage(await expectNoError(getState(cursor, 2, ['fee', 'supply'], user2)))
+                assert.isAtMost(page.converters.length, 2, 'page exceeds the limit')
+                converters.push(...page.converters)
+                cursor = Number(page.next)
+            } while (cursor)
+
+            assert.deepEqual(converters.map(({ currency }) => currency), rows.map(({ currency }) => currency), 'unexpected converters')
+            for (const [i, { fee, supply, reserves, version }] of converters.entries()) {
+                assert.equal(Number(fee), Number(rows[i].fee), 'unexpected fee')
+                if (rows[i].supply) assert.equal(supply, rows[i].supply, 'unexpected supply')
+                assert.isNull(reserves, 'unrequested reserves returned')
+                assert.isNull(version, 'unrequested version returned')
+            }
+        });
+    });
+
+    describe('Oracle', async () => {
+        const twap = result => result.processed.action_traces[0].return_value_data
+
+        it('[gettwap] ensures a valid window with enough price history', async () => {
+            await expectNoError(convertBNT(randomAmount({min: 1, max: 5, decimals: 8 })))
+            await expectError(
+                getTwap('BNTEOS', 0),
+                'window must be positive'
+            )
+            await expectError(
+                getTwap('BNTEOS', 10 * 24 * 3600),
+                'not enough price history for this window'
+            )
+        });
+        it('[oracle] accumulates the prices on the blocks that change the converter', async () => {
+            await expectNoError(convertBNT(randomAmount({min: 1, max: 5, decimals: 8 })))
+            const { rows: [before] } = await getOracle('BNTEOS')
+            const { rows } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+            const { reserves } = rows.find(({ currency }) => currency === '4,BNTEOS')
+            assert.deepEqual(before.reserves, reserves.map(({ symbol }) => symbol), 'unexpected oracle reserves')
+
+            await expectNoError(convertBNT(randomAmount({min: 1, max: 5, decimals: 8 })))
+            const { rows: [after] } = await getOracle('BNTEOS')
+            assert.isAbove(Date.parse(after.last.timestamp), Date.parse(before.last.timestamp), 'observation not updated')
+            after.last.cumulatives.forEach((cumulative, i) =>
+                assert.isAbove(Number(cumulative), Number(before.last.cumulatives[i]), 'cumulative price not accumulated'))
+        });
+        it('[oracle] is paid by the converter owner and allocated at its full size', async () => {
+            const { rows: [{ data, payer }] } = await getOracle('BNTEOS', true)
+            assert.equal(payer, user1, 'unexpected oracle payer')
+            assert.equal(data.observations.length, 48, 'oracle not allocated at its full size')
+        });
+        it('[gettwap] averages to the current prices when nothing changed within the window', async () => {
+            await snooze(2000)
+            const { prices } = twap(await expectNoError(getTwap('BNTEOS', 1)))
+
+            const { rows } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+            const { reserves, supply } = rows.find(({ currency }) => currency === '4,BNTEOS')
+            for (const { symbol, weight, balance } of reserves) {
+                const price = parseFloat(balance.quantity) * 1000000 / (parseFloat(supply) * weight)
+                const { value } = prices.find(({ key }) => key === symbol)
+                assert.closeTo(Number(value), price, price * 1e-9, `unexpected ${symbol} price`)
+            }
+        });
+    });
+
+    describe('Batch', async () => {
+        const reserveBalance = async symbol => {
+            const { rows } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+            const { reserves } = rows.find(({ currency }) => currency === '4,RELAYB')
+            return parseFloat(reserves.find(reserve => reserve.symbol === symbol).balance.quantity)
+        }
+
+        it('[activate] batch mode needs a converter with two reserves', async () => {
+            await expectError(
+                activate(user1, 'TKNA', 'batch'),
+                'batch conversions need a converter with two reserves'
+            )
+            await expectNoError(activate(user1, 'RELAYB', 'batch'))
+            await expectError(
+                setreserve(false, 'eosio.token', 'SYS', bancorConverter, 'RELAYB', user1, 100000),
+                'cannot add reserves to a converter in batch mode'
+            )
+        });
+        it('[settle] ensures a valid limit and queued conversions', async () => {
+            await expectError(
+                settle('RELAYB', 0),
+                'limit must be positive'
+            )
+            await expectError(
+                settle('RELAYB', 1),
+                'no queued conversions'
+            )
+        });
+        const claimable = async (symbol, owner = user1) => {
+            const { rows: [account] } = await getAccount(owner, 'RELAYB', symbol)
+            return account ? parseFloat(account.quantity) : 0
+        }
+
+        it('[convert] queues orders of at least the minimum size', async () => {
+            await expectError(
+                convert('0.00100000 BNT', bntToken, [`${bancorConverter}:RELAYB`, 'EOS']),
+                'order below the minimum size'
+            )
+        });
+        it('[settle] settles the queued conversions of both sides at one price', async () => {
+            const initialBnt = await reserveBalance('BNT')
+            const initialEos = await reserveBalance('EOS')
+            const initialClaimable = { BNT: await claimable('BNT'), EOS: await claimable('EOS') }
+
+            await expectNoError(convert('1.00000000 BNT', bntToken, [`${bancorConverter}:RELAYB`, 'EOS']))
+            await expectNoError(convert('1.0000 EOS', 'eosio.token', [`${bancorConverter}:RELAYB`, 'BNT']))
+            assert.equal((await getOrders('RELAYB')).rows.length, 2, 'conversions not queued')
+            assert.equal(await reserveBalance('BNT'), initialBnt, 'queued conversion changed the reserve')
+            assert.equal(await reserveBalance('EOS'), initialEos, 'queued conversion changed the reserve')
+
+            const result = await expectNoError(settle('RELAYB', 10))
+            assert.equal((await getOrders('RELAYB')).rows.length, 0, 'orders not settled')
+            const [settlement] = logActions(result.processed.action_traces[0]).filter(({ event }) => event === 'batch_settlement')
+            const data = Object.fromEntries(settlement.data.map(({ key, value }) => [key, value]))
+            assert.equal(data.orders, '2', 'unexpected number of settled orders')
+            assert.equal(data.refunds, '0', 'unexpected number of refunds')
+
+            // both sides paid at the same price, the reserves keep the difference
+            const price = Number(data.price)
+            const [a, b] = data.reserve_a === 'BNT' ? ['BNT', 'EOS'] : ['EOS', 'BNT']
+            assert.isAtMost(Number(data.return_b), Number(data.amount_a) * price + 1e-6, 'paid above the clearing price')
+            assert.isAtMost(Number(data.return_a), Number(data.amount_b) / price + 1e-6, 'paid above the clearing price')
+            assert.closeTo(await reserveBalance(a), ({ BNT: initialBnt, EOS: initialEos })[a] + Number(data.amount_a) - Number(data.return_a), 1e-5, 'unexpected reserve balance')
+            assert.closeTo(await reserveBalance(b), ({ BNT: initialBnt, EOS: initialEos })[b] + Number(data.amount_b) - Number(data.return_b), 1e-5, 'unexpected reserve balance')
+
+            // the returns are credited to the destination, which withdraws them
+            assert.closeTo(await claimable(a), initialClaimable[a] + Number(data.return_a), 1e-5, 'return not credited')
+            assert.closeTo(await claimable(b), initialClaimable[b] + Number(data.return_b), 1e-5, 'return not credited')
+            const { rows: [eos] } = await getAccount(user1, 'RELAYB', 'EOS')
+            await expectNoError(withdraw(user1, eos.quantity, 'RELAYB'))
+            assert.equal(await claimable('EOS'), 0, 'return not withdrawn')
+        });
+        it('[settle] refunds the conversions below their minimum return to their traders', async () => {
+            const initialTrader = await claimable('BNT')
+            const initialDestination = await claimable('BNT', user2)
+            await expectNoError(convert('1.00000000 BNT', bntToken, [`${bancorConverter}:RELAYB`, 'EOS'], user1, user2, null, null, '1000.0000'))
+            await expectError(
+                activate(user1, 'RELAYB', 'batch', false),
+                'settle the queued conversions first'
+            )
+            const result = await expectNoError(settle('RELAYB', 10))
+            const [settlement] = logActions(result.processed.action_traces[0]).filter(({ event }) => event === 'batch_settlement')
+            const data = Object.fromEntries(settlement.data.map(({ key, value }) => [key, value]))
+            assert.equal(data.orders, '0', 'unexpected number of settled orders')
+            assert.equal(data.refunds, '1', 'conversion not refunded')
+            assert.closeTo(await claimable('BNT'), initialTrader + 1, 1e-8, 'refund not credited to the trader')
+            assert.equal(await claimable('BNT', user2), initialDestination, 'refund credited to the destination')
+
+            await expectNoError(activate(user1, 'RELAYB', 'batch', false))
+        });
+    });
+
+    describe('Migrations', async () => {
+        it('[migrate] only the contract may run a valid migration task', async () => {
+            await expectError(
+                migrate('supply', 1, user1),
+                ERRORS.PERMISSIONS
+            )
+            await expectError(
+                migrate('balances', 1),
+                'invalid migration task'
+            )
+            await expectError(
+                migrate('supply', 0),
+                'limit must be positive'
+            )
+        });
+        it('[migrate] processes the converters in chunks, continuing from the saved cursor', async () => {
+            const { rows: converters } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+
+            let progress
+            for (let calls = 1; ; calls++) {
+                await expectNoError(migrate('supply', 2))
+                progress = (await getMigration('supply')).rows[0]
+                assert.equal(progress.processed, Math.min(calls * 2, converters.length), 'unexpected number of processed converters')
+                if (progress.done) break
+            }
+            for (const { supply } of (await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)).rows)
+                assert.isDefined(supply, 'converter supply not migrated')
+
+            await expectError(
+                migrate('supply', 2),
+                'migration already complete'
+            )
+        });
+        it('[migrate] moves the reserves out of the legacy maps', async () => {
+            const { rows: before } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+
+            let progress
+            do {
+                await expectNoError(migrate('reserves', 10))
+                progress = (await getMigration('reserves')).rows[0]
+            } while (!progress.done)
+
+            const { rows: after } = await getTableRows(bancorConverter, bancorConverter, 'converters', null, 1000)
+            for (const [i, { currency, reserves, reserve_weights, reserve_balances }] of after.entries()) {
+                assert.equal(reserve_weights.length + reserve_balances.length, 0, `legacy reserves left in ${currency}`)
+                const legacy = before[i].reserves || before[i].reserve_balances.map(({ key, value }) => ({
+                    symbol: key, weight: before[i].reserve_weights.find(weight => weight.key === key).value, balance: value
+                }))
+                assert.deepEqual(reserves, legacy, `reserves of ${currency} changed`)
+            }
+        });
+        it('[cleartables] completes on a converter without v1 tables', async () => {
+            await expectNoError(clearTables('BNTEOS', 10))
+            const progress = (await getMigration('cleartables')).rows[0]
+            assert.equal(progress.processed, 0, 'unexpected number of erased rows')
+            assert.isTrue(!!progress.done, 'clearing not completed')
+        });
     });
 
     describe('Input validations', async () => {
@@ -39,7 +39,27 @@ const setMaxAffiliateFee = async function(actor, max_affiliate_fee, account = ac
     return result;
 }
 
+const registerConverter = async function(actor, converter, smart_token, account = actor) {
+    const result = await api.transact({
+        actions: [{
+            account,
+            name: "regconverter",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: { account: converter, smart_token }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+
 module.exports = {
     setNetworkToken,
-    setMaxAffiliateFee
+    setMaxAffiliateFee,
+    registerConverter
 };
@@ -90,6 +90,48 @@ async function rmreporter(reporter) {
 }
 
 
+async function addchain(blockchain, actor = bancorXContract) {
+    return api.transact({
+        actions: [{
+            account: bancorXContract,
+            name: "addchain",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                blockchain
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+
+async function rmchain(blockchain, actor = bancorXContract) {
+    return api.transact({
+        actions: [{
+            account: bancorXContract,
+            name: "rmchain",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                blockchain
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+
 async function update(
     { min_reporters, min_limit, limit_inc, max_issue_limit, max_destroy_limit },
     authorization = { actor: bancorXContract, permission: 'active' }
@@ -147,5 +189,7 @@ module.exports = {
     enablerpt,
     addreporter,
     rmreporter,
+    addchain,
+    rmchain,
     update
 };
@@ -75,6 +75,20 @@ const getConverter = async function (symbol) {
         throw(err)
     }
 }
+const getMigration = async function (task) {
+    try {
+        const result = await rpc.get_table_rows({
+            "code": bancorConverter,
+            "scope": bancorConverter,
+            "table": "migrations",
+            "limit": 1,
+            "lower_bound": task
+        })
+        return result
+    } catch (err) {
+        throw(err)
+    }
+}
 const init = async function (converter = bntConverter, actor = converter, relay = bntRelay, symbol = bntRelaySymbol, fee = 0, smart_enabled = false) {
     try {
         const result = await api.transact({
@@ -194,6 +208,24 @@ const activateStaking = async function(stake_contract = bntStaking, stake_enable
         throw(err)
     }
 }
+const syncBalances = async function(converter = bntConverter, actor = converter) {
+    const result = await api.transact({
+        actions: [{
+            account: converter,
+            name: "syncbalances",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {}
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
 const setreserve = async function(precise = true, token = networkToken,
                                   symbol = networkTokenSymbol,
                                   converter = bntConverter,
@@ -418,6 +450,184 @@ const updateFee = async function(actor, currency, fee) {
     })
     return result;
 }
+const setEvents = async function(actor, currency, mode, threshold = 0) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "setevents",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                currency,
+                mode,
+                threshold
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const migrate = async function(task, limit, actor = bancorConverter) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "migrate",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                task,
+                limit
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const getState = async function(cursor, limit, fields = [], actor = config.MASTER_ACCOUNT) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "getstate",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                cursor,
+                limit,
+                fields
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const getTwap = async function(currency, window, actor = config.MASTER_ACCOUNT) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "gettwap",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                currency,
+                window
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const getOracle = async function (currency, showPayer = false) {
+    try {
+        const result = await rpc.get_table_rows({
+            "code": bancorConverter,
+            "scope": bancorConverter,
+            "table": "oracles",
+            "limit": 1,
+            "lower_bound": currency,
+            "show_payer": showPayer
+        })
+        return result
+    } catch (err) {
+        throw(err)
+    }
+}
+const activate = async function(actor, currency, protocol_feature, enabled = true) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "activate",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                currency,
+                protocol_feature,
+                enabled
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const settle = async function(currency, limit, actor = config.MASTER_ACCOUNT) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "settle",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                currency,
+                limit
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
+const getOrders = async function (currency) {
+    try {
+        const result = await rpc.get_table_rows({
+            "code": bancorConverter,
+            "scope": currency,
+            "table": "orders",
+            "limit": 100
+        })
+        return result
+    } catch (err) {
+        throw(err)
+    }
+}
+const clearTables = async function(currency, limit, actor = bancorConverter) {
+    const result = await api.transact({
+        actions: [{
+            account: bancorConverter,
+            name: "cleartables",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                currency,
+                limit
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+    return result;
+}
 const withdraw = async function(sender, quantity, converter_currency_code) {
     const result = await api.transact({
         actions: [{
@@ -461,11 +671,14 @@ const fund = async function(sender, quantity) {
     })
     return result;
 }
-module.exports = { init, update, enableStake,
+module.exports = { init, update, enableStake, syncBalances,
                    activateStaking, setStaking,
                    setreserve, getReserve, delreserve,
                    getSettings, setMultitoken,
-                   setMaxfee, updateFee, updateOwner,
+                   setMaxfee, updateFee, updateOwner, setEvents,
                    setEnabled, enableConvert, getAccount,
                    getConverter, createConverter,
-                   delConverter, withdraw, fund }
+                   delConverter, withdraw, fund,
+                   migrate, clearTables, getMigration, getState,
+                   getTwap, getOracle,
+                   activate, settle, getOrders }
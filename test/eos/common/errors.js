@@ -20,6 +20,8 @@ module.exports = Object.freeze({
         DUPLICATE_TRANSACTION: 'Duplicate transaction',
         REPORTER_ALREADY_DEFINED: 'reporter already defined',
         REPORTER_DOESNT_EXIST: 'reporter does not exist',
+        UNSUPPORTED_BLOCKCHAIN: 'unsupported blockchain',
+        BLOCKCHAIN_ALREADY_SUPPORTED: 'blockchain already supported',
         TRANSFER_DATA_MISMATCH: 'transfer data doesn\'t match',
         SINGLETON_DOESNT_EXIST: 'singleton does not exist',
         REROUTING_DISABLED: 'transaction rerouting is disabled',
@@ -0,0 +1,100 @@
+const { api } = require('./utils');
+const config = require('../../../config/accountNames.json')
+
+const rerouterContract = config.TX_REROUTER_ACCOUNT;
+
+
+async function enablerrt(enable) {
+    return api.transact({
+        actions: [{
+            account: rerouterContract,
+            name: "enablerrt",
+            authorization: [{
+                actor: rerouterContract,
+                permission: 'active',
+            }],
+            data: {
+                enable
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+
+async function reroutetx({ tx_id, blockchain = 'eth', target = 'ETH_ADDRESS' }, actor) {
+    return api.transact({
+        actions: [{
+            account: rerouterContract,
+            name: "reroutetx",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                tx_id,
+                blockchain,
+                target
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+
+async function setreroute({ sender, tx_id, blockchain = 'eth', target = 'ETH_ADDRESS' }, actor = sender) {
+    return api.transact({
+        actions: [{
+            account: rerouterContract,
+            name: "setreroute",
+            authorization: [{
+                actor,
+                permission: 'active',
+            }],
+            data: {
+                sender,
+                tx_id,
+                blockchain,
+                target
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+
+async function reroutetxs(reroutes, actors) {
+    return api.transact({
+        actions: [{
+            account: rerouterContract,
+            name: "reroutetxs",
+            authorization: actors.map(actor => ({
+                actor,
+                permission: 'active',
+            })),
+            data: {
+                reroutes
+            }
+        }]
+    },
+    {
+        blocksBehind: 3,
+        expireSeconds: 30,
+    })
+}
+
+module.exports = {
+    enablerrt,
+    reroutetx,
+    setreroute,
+    reroutetxs
+};
@@ -22,7 +22,8 @@ const {
     setreserve,
     delreserve,
     getReserve,
-    getSettings
+    getSettings,
+    syncBalances
 } = require('./common/converter')
 
 const { ERRORS } = require('./common/errors')
@@ -267,6 +268,33 @@ describe('Test: BancorConverter (old version)', () => {
             assert.equal(result.rows[0].fee, 10000, "fee not set correctly")
         })
     })
+    describe('reserve balances kept by the converter', function () {
+        it('reserve balances follow the setup transfers', async function () {
+            for (const [symbol, contract] of [['BNT', networkTokenContract], ['SYS', 'fakeos']]) {
+                const reserve = (await getReserve(symbol, 'bnt2syscnvrt')).rows[0]
+                const balance = (await getBalance('bnt2syscnvrt', contract, symbol)).rows[0]
+                assert.equal(reserve.balance, balance.balance, `reserve balance not kept correctly - ${symbol}`)
+            }
+        })
+        it('syncbalances with bad auth', async function () {
+            await expectError(
+                syncBalances('bnt2syscnvrt', user1),
+                ERRORS.PERMISSIONS
+            )
+        })
+        it('syncbalances reads the token contracts', async function () {
+            await expectNoError(
+                syncBalances('bnt2syscnvrt')
+            )
+            const settings = (await getSettings('bnt2syscnvrt')).rows[0]
+            const stat = (await get('bnt2sysrelay', 'BNTSYS')).rows[0]
+            assert.equal(settings.supply, stat.supply, "smart token supply not synced")
+
+            const reserve = (await getReserve('BNT', 'bnt2syscnvrt')).rows[0]
+            const balance = (await getBalance('bnt2syscnvrt', networkTokenContract, 'BNT')).rows[0]
+            assert.equal(reserve.balance, balance.balance, "reserve balance not synced")
+        })
+    })
     describe('some last invalid ops', function () {
         it("trying to delete BNT reserve when it's not empty - should throw", async () => {
             await expectError(
@@ -23,11 +23,16 @@ const {
     getReserve
 } = require('./common/converter')
 
+const {
+    registerConverter
+} = require('./common/bancor-network')
+
 const { ERRORS } = require('./common/errors')
 const user1 = config.MASTER_ACCOUNT
 const user2 = config.TEST_ACCOUNT
 const bancorConverter = config.MULTI_CONVERTER_ACCOUNT
 const bntToken = config.BNT_TOKEN_ACCOUNT
+const bancorNetwork = config.BANCOR_NETWORK_ACCOUNT
 
 describe('Test: BancorNetwork', () => {
     describe('Affiliate Fees', async () => {
@@ -151,4 +156,22 @@ describe('Test: BancorNetwork', () => {
             ERRORS.MUST_HAVE_TOKEN_ENTRY
         )
     })
+    it("ensures a path through a smart token its registered converter doesn't hold is rejected before the first conversion", async () => {
+        await expectError(
+            convert('1.00000000 BNT', bntToken, [`${bancorConverter}:BNTNOPE`, 'EOS']),
+            "converter does not exist"
+        )
+    })
+    it("ensures only the network can register converters", async () => {
+        await expectError(
+            registerConverter(user2, bancorConverter, 'TKNB', bancorNetwork),
+            ERRORS.PERMISSIONS
+        )
+    })
+    it("ensures a path to a symbol a registered converter doesn't hold is rejected before the first conversion", async () => {
+        await expectError(
+            convert('1.00000000 BNT', bntToken, [`${bancorConverter}:BNTEOS`, 'EOS', `${bancorConverter}:BNTEOS`, 'NOPE']),
+            "converter cannot convert to path symbol"
+        )
+    })
 })
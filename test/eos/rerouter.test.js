@@ -0,0 +1,111 @@
+const assert = require('chai').should();
+const {
+    expectError,
+    expectNoError,
+    getTableRows
+} = require('./common/utils');
+
+const config = require('../../config/accountNames.json')
+
+const {
+    enablerrt,
+    reroutetx,
+    setreroute,
+    reroutetxs
+} = require('./common/rerouter');
+const { ERRORS } = require('./common/errors');
+
+
+describe('XTransferRerouter', () => {
+    const rerouterContract = config.TX_REROUTER_ACCOUNT;
+    const testUser = config.MASTER_ACCOUNT;
+    const testUser2 = config.TEST_ACCOUNT;
+
+    const getReroute = async (sender, tx_id) => (await getTableRows(rerouterContract, sender, 'reroutes', null, 1000)).rows
+        .find(row => row.tx_id === tx_id);
+
+    before(async () => {
+        await expectNoError(
+            enablerrt(true)
+        );
+    })
+
+    it('should throw when attempting to reroute when rerouting is disabled', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+        await expectNoError(
+            enablerrt(false)
+        );
+        await expectError(
+            reroutetx({ tx_id: transferId }, testUser),
+            ERRORS.REROUTING_DISABLED
+        );
+        await expectError(
+            setreroute({ tx_id: transferId, sender: testUser }),
+            ERRORS.REROUTING_DISABLED
+        );
+        await expectNoError(
+            enablerrt(true)
+        );
+    })
+
+    it('ensures reroutetx keeps its signature and only logs the reroute', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+
+        await expectNoError(
+            reroutetx({ tx_id: transferId }, testUser)
+        );
+        assert.equal(await getReroute(testUser, transferId), undefined);
+    })
+
+    it('ensures only the sender may reroute in its own name', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+
+        await expectError(
+            setreroute({ tx_id: transferId, sender: testUser }, testUser2),
+            ERRORS.PERMISSIONS
+        );
+        assert.equal(await getReroute(testUser, transferId), undefined);
+    })
+
+    it('ensures the reroutes of a tx_id are kept per sender, and the contract may change them', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+
+        // another sender rerouting the same tx_id first doesn't lock the sender out
+        await expectNoError(
+            setreroute({ tx_id: transferId, target: 'ETH_ADDRESS_1', sender: testUser2 })
+        );
+        await expectNoError(
+            setreroute({ tx_id: transferId, target: 'ETH_ADDRESS_2', sender: testUser })
+        );
+        (await getReroute(testUser2, transferId)).target.should.be.equal('ETH_ADDRESS_1');
+        (await getReroute(testUser, transferId)).target.should.be.equal('ETH_ADDRESS_2');
+
+        await expectNoError(
+            setreroute({ tx_id: transferId, target: 'ETH_ADDRESS_3', sender: testUser })
+        );
+        await expectNoError(
+            setreroute({ tx_id: transferId, target: 'ETH_ADDRESS_4', sender: testUser }, rerouterContract)
+        );
+
+        const reroute = await getReroute(testUser, transferId);
+        reroute.sender.should.be.equal(testUser);
+        reroute.target.should.be.equal('ETH_ADDRESS_4');
+    })
+
+    it('ensures reroutetxs requires the authorization of every sender', async () => {
+        const transferId = Math.floor(100000 + Math.random() * 900000)
+        const reroutes = [
+            { tx_id: transferId, blockchain: 'eth', target: 'ETH_ADDRESS', sender: testUser },
+            { tx_id: transferId + 1, blockchain: 'eth', target: 'ETH_ADDRESS', sender: testUser2 }
+        ];
+
+        await expectError(
+            reroutetxs(reroutes, [testUser]),
+            ERRORS.PERMISSIONS
+        );
+        await expectNoError(
+            reroutetxs(reroutes, [testUser, testUser2])
+        );
+        (await getReroute(testUser2, transferId + 1)).sender.should.be.equal(testUser2);
+    })
+});
@@ -0,0 +1,171 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief scans a snapshot of the multi-converter's pools for profitable conversion cycles through the BNT hub
+ *  (tools/arbitrage/cycles.hpp) and prints them with ready to send conversion memos
+ *
+ *  usage: arbitrage <converters.json> [--updates updates.jsonl] [--account multiconvert] [--multi-token multi4tokens]
+ *                   [--network thisisbancor] [--hubs BNT] [--start BNT] [--max-hops 4] [--min-profit 0.0001]
+ *                   [--trader bnttestuser1] [--top 20]
+ *
+ *  `converters.json` is a `converters` table dump (`cleos get table multiconvert multiconvert converters -l -1`).
+ *  every line of `--updates` holds the changed rows of one block, as a row or a table dump; only the cycles through the
+ *  changed converters are re-evaluated, and the opportunities that appeared, changed or vanished are printed per update.
+ *  `--min-profit` is in units of the start token, the memos' minimum return covers the input amount and that profit
+ */
+#include "arbitrage/cycles.hpp"
+#include "pool/json.hpp"
+#include "pool/snapshot.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct options {
+    std::string         state_file;
+    std::string         updates_file;
+    std::string         network = "thisisbancor";
+    std::string         trader = "bnttestuser1";
+    double              min_profit = 0;
+    size_t              top = 20;
+    arbitrage::settings settings;
+};
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    for (size_t start = 0, end; start <= list.size(); start = end + 1) {
+        end = std::min(list.find(',', start), list.size());
+        if (end > start) items.push_back(list.substr(start, end - start));
+    }
+    return items;
+}
+
+options parse_options(const int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 == argc) throw std::runtime_error(arg + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--updates") opts.updates_file = value();
+        else if (arg == "--account") opts.settings.account = value();
+        else if (arg == "--multi-token") opts.settings.multi_token = value();
+        else if (arg == "--network") opts.network = value();
+        else if (arg == "--hubs") opts.settings.hubs = split(value());
+        else if (arg == "--start") opts.settings.start = split(value());
+        else if (arg == "--max-hops") opts.settings.max_hops = std::stoul(value());
+        else if (arg == "--min-profit") opts.min_profit = std::stod(value());
+        else if (arg == "--trader") opts.trader = value();
+        else if (arg == "--top") opts.top = std::stoul(value());
+        else if (arg[0] != '-' && opts.state_file.empty()) opts.state_file = arg;
+        else throw std::runtime_error("unknown argument " + arg);
+    }
+    if (opts.state_file.empty()) throw std::runtime_error("no converters snapshot given");
+    if (opts.settings.max_hops < 2) throw std::runtime_error("cycles need at least 2 hops");
+    return opts;
+}
+
+int64_t min_profit(const options& opts, const arbitrage::cycle& cy) {
+    return pool::round_amount(opts.min_profit, cy.precision);
+}
+
+void print(const options& opts, const arbitrage::scanner& scanner, const arbitrage::opportunity& o, const char* prefix = "") {
+    const arbitrage::cycle& cy = scanner.cycles()[o.cycle];
+    const std::string& contract = cy.token.substr(cy.token.find('@') + 1);
+    printf("%sprofit %s %s on %s %s: %s\n", prefix, pool::format_amount(o.profit(), cy.precision).c_str(), cy.symbol.c_str(),
+           pool::format_amount(o.amount, cy.precision).c_str(), cy.symbol.c_str(), scanner.describe(o.cycle).c_str());
+    printf("%s  %s transfer %s %s to %s, memo \"%s\"\n", prefix, contract.c_str(), pool::format_amount(o.amount, cy.precision).c_str(),
+           cy.symbol.c_str(), opts.network.c_str(), scanner.memo(o, opts.trader, min_profit(opts, cy)).c_str());
+}
+
+// the converters rows of an update line, a single row or a table dump
+std::vector<pool::converter> parse_update(const std::string& line) {
+    const json::value update = json::parse(line);
+    if (update.kind == json::value::object && !update.find("rows")) return { pool::load_converter(update) };
+    return pool::load_converters(update);
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    std::vector<pool::converter> converters;
+    try {
+        opts = parse_options(argc, argv);
+        converters = pool::load_converters_file(opts.state_file);
+    }
+    catch (const std::exception& err) {
+        fprintf(stderr, "%s\nsee the usage in tools/arbitrage/arbitrage.cpp\n", err.what());
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    arbitrage::scanner scanner(std::move(converters), opts.settings);
+    scanner.scan();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    const auto profitable = [&](const arbitrage::opportunity& o) {
+        return o.profit() > min_profit(opts, scanner.cycles()[o.cycle]);
+    };
+    std::vector<arbitrage::opportunity> found;
+    for (const auto& o : scanner.opportunities())
+        if (profitable(o)) found.push_back(o);
+
+    printf("%zu converters, %zu cycles scanned in %.0fus, %zu profitable\n", scanner.converters().size(), scanner.cycles().size(), us, found.size());
+    for (size_t i = 0; i < std::min(found.size(), opts.top); i++) print(opts, scanner, found[i]);
+    if (opts.updates_file.empty()) return 0;
+
+    std::ifstream updates(opts.updates_file);
+    if (!updates) {
+        fprintf(stderr, "cannot read %s\n", opts.updates_file.c_str());
+        return 2;
+    }
+
+    size_t line_number = 0, total_evaluated = 0;
+    for (std::string line; std::getline(updates, line);) {
+        line_number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::vector<pool::converter> changed;
+        try {
+            changed = parse_update(line);
+        }
+        catch (const std::exception& err) {
+            fprintf(stderr, "update %zu: %s\n", line_number, err.what());
+            continue;
+        }
+
+        // the opportunities of the cycles through the changed pools, before and after
+        std::map<size_t, arbitrage::opportunity> before;
+        for (const auto& o : scanner.opportunities()) before[o.cycle] = o;
+
+        start = std::chrono::steady_clock::now();
+        std::set<size_t> evaluated;
+        const size_t generation = scanner.generation();
+        for (const pool::converter& c : changed) {
+            const std::vector<size_t> indices = scanner.update(c);
+            evaluated.insert(indices.begin(), indices.end());
+        }
+        const bool restructured = generation != scanner.generation();
+        us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        total_evaluated += evaluated.size();
+
+        printf("\nupdate %zu: %zu converters changed, %zu of %zu cycles re-evaluated in %.0fus%s\n", line_number, changed.size(),
+               evaluated.size(), scanner.cycles().size(), us, restructured ? " (cycles rebuilt)" : "");
+        for (const size_t i : evaluated) {
+            const arbitrage::opportunity& now = scanner.best(i);
+            const auto was = before.find(i);
+            const bool was_profitable = !restructured && was != before.end() && profitable(was->second);
+            if (profitable(now) && (!was_profitable || was->second.amount != now.amount || was->second.output != now.output))
+                print(opts, scanner, now, was_profitable ? "  changed " : "  new     ");
+            else if (!profitable(now) && was_profitable)
+                printf("  gone    %s\n", scanner.describe(i).c_str());
+        }
+    }
+    printf("\n%zu updates, %zu cycle evaluations (a rescan per update would take %zu)\n", line_number, total_evaluated, line_number * scanner.cycles().size());
+    return 0;
+}
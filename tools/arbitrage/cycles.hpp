@@ -0,0 +1,294 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include "pool/pool.hpp"
+#include "pool/snapshot.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @defgroup Arbitrage Arbitrage
+ * @brief closed conversion cycles over the multi-converter's pools
+ * @details tokens (reserves and smart tokens, by symbol and contract) are the nodes of the graph, and every converter
+ * links each pair of its tokens. `scanner` enumerates the simple cycles of up to `max_hops` hops that start at one of the
+ * `start` tokens and pass through a hub (BNT), skipping cycles within a single pool (a round trip through one pool only
+ * pays its fees) and cycles buying a smart token before their last hop (the contract only issues smart tokens on the
+ * final hop of a path).
+ * A cycle is evaluated with the contract's math (`pool::quote`, including the `magnitude` 2 fee of reserve --> reserve
+ * hops and the truncation of every return): the product of its marginal rates rules it out if it can't be profitable,
+ * otherwise the input amount with the highest profit is searched for.
+ * The cycles through every converter are indexed, so `update` only re-evaluates the cycles through the changed pools.
+ * @{
+ */
+namespace arbitrage {
+    struct settings {
+        std::string                 account = "multiconvert";     // multi-converter contract, the converter account in memo paths
+        std::string                 multi_token = "multi4tokens"; // smart token contract
+        std::vector<std::string>    hubs = { "BNT" };             // symbols, or symbol@contract
+        std::vector<std::string>    start;                        // tokens the cycles start (and end) at, the hubs if empty
+        size_t                      max_hops = 4;
+    };
+
+    struct hop {
+        size_t      converter;  // index in `scanner::converters()`
+        std::string from;
+        std::string to;
+    };
+
+    struct cycle {
+        std::string         token;      // start token, symbol@contract
+        std::string         symbol;
+        uint8_t             precision;
+        std::vector<hop>    hops;
+        bool                repeats;    // a converter is used more than once, later hops see the state of the earlier ones
+    };
+
+    struct opportunity {
+        size_t  cycle;
+        int64_t amount = 0;     // raw, in the start token
+        int64_t output = 0;
+        int64_t profit() const { return output - amount; }
+    };
+
+    class scanner {
+        public:
+            scanner(std::vector<pool::converter> converters, settings s) : _converters(std::move(converters)), _settings(std::move(s)) {
+                if (_settings.start.empty()) _settings.start = _settings.hubs;
+                rebuild();
+            }
+
+            const std::vector<pool::converter>& converters() const { return _converters; }
+            const std::vector<cycle>& cycles() const { return _cycles; }
+
+            // changes whenever the cycles are enumerated again, which renumbers them
+            size_t generation() const { return _generation; }
+
+            // evaluates every cycle
+            void scan() {
+                for (size_t i = 0; i < _cycles.size(); i++) _best[i] = evaluate(i);
+            }
+
+            // replaces a converter's state and re-evaluates the cycles through it (all of them if its tokens changed),
+            // returns the indices of the re-evaluated cycles
+            std::vector<size_t> update(const pool::converter& c) {
+                const auto itr = std::find_if(_converters.begin(), _converters.end(), [&](const pool::converter& existing) { return existing.currency == c.currency; });
+                const bool added = itr == _converters.end();
+                const bool restructured = added || structure(*itr) != structure(c);
+                if (added) _converters.push_back(c);
+                else *itr = c;
+
+                std::vector<size_t> evaluated;
+                if (restructured) {
+                    rebuild();
+                    for (size_t i = 0; i < _cycles.size(); i++) evaluated.push_back(i);
+                }
+                else evaluated = _by_converter[itr - _converters.begin()];
+
+                for (const size_t i : evaluated) _best[i] = evaluate(i);
+                return evaluated;
+            }
+
+            // the profitable opportunities of the last evaluations, the most profitable first (profits of one start token)
+            std::vector<opportunity> opportunities(const int64_t min_profit = 0) const {
+                std::vector<opportunity> result;
+                for (const opportunity& o : _best)
+                    if (o.profit() > min_profit) result.push_back(o);
+                std::sort(result.begin(), result.end(), [&](const opportunity& a, const opportunity& b) {
+                    if (_cycles[a.cycle].token != _cycles[b.cycle].token) return _cycles[a.cycle].token < _cycles[b.cycle].token;
+                    return a.profit() > b.profit();
+                });
+                return result;
+            }
+
+            const opportunity& best(const size_t cycle) const { return _best[cycle]; }
+
+            // the conversion memo of an opportunity (`build_memo` format), the return has to cover the input and `min_profit`
+            std::string memo(const opportunity& o, const std::string& trader, const int64_t min_profit = 0) const {
+                const cycle& cy = _cycles[o.cycle];
+                std::string path;
+                for (const hop& h : cy.hops) {
+                    if (!path.empty()) path += " ";
+                    path += _settings.account + ":" + _converters[h.converter].currency + " " + h.to;
+                }
+                return "1," + path + "," + pool::format_amount(o.amount + min_profit, cy.precision) + "," + trader + ";arbitrage";
+            }
+
+            // "BNT -BNTEOS-> EOS -BNTEOS2-> BNT"
+            std::string describe(const size_t index) const {
+                const cycle& cy = _cycles[index];
+                std::string text = cy.symbol;
+                for (const hop& h : cy.hops) text += " -" + _converters[h.converter].currency + "-> " + h.to;
+                return text;
+            }
+
+        private:
+            struct node {
+                std::string symbol;
+                std::string token;      // symbol@contract
+                uint8_t     precision;
+                bool        smart;
+            };
+
+            std::vector<pool::converter>        _converters;
+            settings                            _settings;
+            std::vector<cycle>                  _cycles;
+            std::vector<std::vector<size_t>>    _by_converter;  // cycles through every converter
+            std::vector<opportunity>            _best;          // per cycle
+            size_t                              _generation = 0;
+
+            std::vector<node> tokens(const pool::converter& c) const {
+                std::vector<node> result;
+                for (const auto& r : c.reserves) result.push_back({ r.first, r.first + "@" + r.second.contract, r.second.precision, false });
+                result.push_back({ c.currency, c.currency + "@" + _settings.multi_token, pool::SMART_TOKEN_PRECISION, true });
+                return result;
+            }
+
+            // the tokens and whether the converter can be quoted, changes of either change the cycles through it
+            std::string structure(const pool::converter& c) const {
+                std::string result = usable(c) ? "usable" : "unusable";
+                for (const node& n : tokens(c)) result += " " + n.token + "/" + std::to_string(n.precision);
+                return result;
+            }
+
+            // inactive converters (an empty reserve) and converters without a known supply can't be quoted
+            static bool usable(const pool::converter& c) {
+                if (c.supply <= 0) return false;
+                for (const auto& r : c.reserves)
+                    if (r.second.balance <= 0 || !r.second.weight) return false;
+                return !c.reserves.empty();
+            }
+
+            static bool matches(const std::vector<std::string>& list, const node& n) {
+                for (const std::string& entry : list)
+                    if (entry == n.symbol || entry == n.token) return true;
+                return false;
+            }
+
+            struct edge {
+                size_t  converter;
+                node    from;
+                node    to;
+            };
+
+            void rebuild() {
+                std::map<std::string, std::vector<edge>> edges;
+                std::map<std::string, node> nodes;
+                for (size_t i = 0; i < _converters.size(); i++) {
+                    if (!usable(_converters[i])) continue;
+                    const std::vector<node> converter_tokens = tokens(_converters[i]);
+                    for (const node& from : converter_tokens) {
+                        nodes[from.token] = from;
+                        for (const node& to : converter_tokens)
+                            if (from.token != to.token) edges[from.token].push_back({ i, from, to });
+                    }
+                }
+
+                _generation++;
+                _cycles.clear();
+                _by_converter.assign(_converters.size(), {});
+                std::vector<hop> path;
+                std::set<std::string> visited;
+                for (const auto& n : nodes)
+                    if (matches(_settings.start, n.second)) {
+                        visited = { n.first };
+                        enumerate(n.second, n.first, matches(_settings.hubs, n.second), edges, path, visited);
+                    }
+                _best.assign(_cycles.size(), opportunity{});
+                for (size_t i = 0; i < _cycles.size(); i++) _best[i].cycle = i;
+            }
+
+            void enumerate(const node& start, const std::string& at, const bool through_hub, const std::map<std::string, std::vector<edge>>& edges,
+                           std::vector<hop>& path, std::set<std::string>& visited) {
+                const auto out = edges.find(at);
+                if (out == edges.end()) return;
+
+                for (const edge& e : out->second) {
+                    if (e.to.smart && e.to.token != start.token) continue;
+                    path.push_back({ e.converter, e.from.symbol, e.to.symbol });
+
+                    if (e.to.token == start.token) {
+                        if (through_hub && path.size() >= 2) record(start, path);
+                    }
+                    else if (path.size() < _settings.max_hops && !visited.count(e.to.token)) {
+                        visited.insert(e.to.token);
+                        enumerate(start, e.to.token, through_hub || matches(_settings.hubs, e.to), edges, path, visited);
+                        visited.erase(e.to.token);
+                    }
+                    path.pop_back();
+                }
+            }
+
+            void record(const node& start, const std::vector<hop>& path) {
+                std::set<size_t> used;
+                for (const hop& h : path) used.insert(h.converter);
+                if (used.size() == 1) return;
+
+                _cycles.push_back({ start.token, start.symbol, start.precision, path, used.size() < path.size() });
+                for (const size_t c : used) _by_converter[c].push_back(_cycles.size() - 1);
+            }
+
+            // the marginal rate of a conversion, after the fee
+            double marginal_rate(const pool::converter& c, const hop& h) const {
+                const bool from_smart = h.from == c.currency, to_smart = h.to == c.currency;
+                const double supply = pool::to_units(c.supply, pool::SMART_TOKEN_PRECISION);
+                const auto balance = [&](const std::string& symbol) {
+                    const pool::reserve& r = c.reserves.at(symbol);
+                    return pool::to_units(r.balance, r.precision);
+                };
+
+                double rate;
+                if (from_smart) rate = balance(h.to) * curves::MAX_WEIGHT / (supply * c.reserves.at(h.to).weight);
+                else if (to_smart) rate = supply * c.reserves.at(h.from).weight / (curves::MAX_WEIGHT * balance(h.from));
+                else rate = balance(h.to) / balance(h.from) * c.reserves.at(h.from).weight / c.reserves.at(h.to).weight;
+                return rate * pow(1 - c.fee / curves::MAX_FEE, from_smart || to_smart ? 1 : 2);
+            }
+
+            // the return of `amount` sent around a cycle, 0 if a hop returns nothing
+            int64_t run(const cycle& cy, int64_t amount) const {
+                std::map<size_t, pool::converter> touched;
+                for (const hop& h : cy.hops) {
+                    if (!cy.repeats) {
+                        amount = pool::quote(_converters[h.converter], h.from, h.to, amount).amount;
+                    }
+                    else {
+                        const auto itr = touched.emplace(h.converter, _converters[h.converter]).first;
+                        amount = pool::convert(itr->second, h.from, h.to, amount).amount;
+                    }
+                    if (amount <= 0) return 0;
+                }
+                return amount;
+            }
+
+            opportunity evaluate(const size_t index) const {
+                const cycle& cy = _cycles[index];
+                opportunity best{ index };
+
+                double rate = 1;
+                for (const hop& h : cy.hops) rate *= marginal_rate(_converters[h.converter], h);
+                if (!(rate > 1)) return best;
+
+                // the profit is concave in the input up to the truncations, searched up to the start token's balance in the first pool
+                const pool::converter& first = _converters[cy.hops.front().converter];
+                double low = 1, high = cy.hops.front().from == first.currency ? first.supply : first.reserves.at(cy.hops.front().from).balance;
+                const auto profit = [&](const double amount) { return double(run(cy, amount)) - int64_t(amount); };
+                for (int i = 0; i < 100 && high - low > 1; i++) {
+                    const double m1 = low + (high - low) / 3, m2 = high - (high - low) / 3;
+                    if (profit(m1) < profit(m2)) low = m1;
+                    else high = m2;
+                }
+
+                best.amount = low;
+                best.output = run(cy, best.amount);
+                if (best.output <= best.amount) best = opportunity{ index };
+                return best;
+            }
+    };
+}
+/** @}*/
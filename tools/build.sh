@@ -0,0 +1,19 @@
+#!/bin/bash
+# builds the host tools, usage: ./tools/build.sh [tool...], each tool is tools/<tool>/<tool>.cpp
+set -e
+
+GREEN='\033[0;32m'
+NC='\033[0m'
+
+CXX=${CXX:-g++}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=${BUILD_DIR:-/tmp/bancor_tools}
+TOOLS=${@:-$(cd "$ROOT/tools" && ls */*.cpp | sed 's/\/.*$//' | sort -u)}
+
+mkdir -p $BUILD_DIR
+for tool in $TOOLS
+do
+    echo -e "${GREEN}--> $tool${NC}"
+    $CXX -std=c++17 -O2 -ffp-contract=off -I$ROOT/contracts/eos/Common -I$ROOT/tools $ROOT/tools/$tool/$tool.cpp -o $BUILD_DIR/$tool -lpthread
+done
+echo "built into $BUILD_DIR"
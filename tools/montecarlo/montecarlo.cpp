@@ -0,0 +1,356 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief Monte Carlo risk simulator for one multi-converter pool: runs randomized trade sequences against the host
+ *  converter model (tools/pool, the contract's `calculate_return`, `calculate_fund_cost` and `calculate_liquidate_return`
+ *  formulas and rounding) and reports the distributions of the LP value, the fees earned and the slippage
+ *
+ *  usage: montecarlo [--state converters.json --converter BNTEOS | --reserves BNT:8:500000:1000000,EOS:4:500000:300000 --supply 1000000]
+ *                    [--fee 1000,2500,5000] [--weights "BNT=500000,EOS=500000;BNT=400000,EOS=400000"] [--base BNT]
+ *                    [--scenarios 2000] [--steps 500] [--trades 4] [--trade-size 0.002] [--volatility 0.5]
+ *                    [--lp-share 0.5] [--lp-flow 0.02] [--seed 1] [--threads N] [--grain 4]
+ *
+ *  every scenario follows one path of external prices (a geometric brownian motion of each reserve against the `base`
+ *  reserve, `volatility` over the whole run) in `steps` steps; on each step
+ *  - arbitrageurs convert between every reserve and the base reserve up to the most profitable amount at the new prices
+ *  - `trades` noise trades convert between random tokens (reserves and the smart token), exponentially sized with a
+ *    mean of `trade-size` of the sold balance (conversions the contract would reject are counted and skipped)
+ *  - with probability `lp-flow`, other liquidity providers fund or liquidate up to 2 * `trade-size` of the supply
+ *  the simulated LP holds `lp-share` of the initial supply and liquidates it at the end; its value is compared with the
+ *  initial value and with holding its initial reserve amounts (HODL), all valued at the external prices in the base reserve.
+ *  fees are all the pool's conversion fees in % of the initial pool value, slippage the mean price impact of the noise
+ *  trades before the fee, in bps.
+ *  every configuration of the `fee` x `weights` sweep runs the same scenarios (seeds), i.e. the same price paths and
+ *  order flow; scenarios are spread over the cores by a work-stealing scheduler
+ */
+#include "montecarlo/work_stealing.hpp"
+#include "pool/pool.hpp"
+#include "pool/snapshot.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+struct options {
+    std::string                 state_file;
+    std::string                 converter;
+    std::string                 reserves = "BNT:8:500000:1000000,EOS:4:500000:300000";
+    double                      supply = 1000000;
+    std::string                 fees;
+    std::string                 weights;
+    std::string                 base;
+    size_t                      scenarios = 2000;
+    size_t                      steps = 500;
+    size_t                      trades = 4;
+    double                      trade_size = 0.002;
+    double                      volatility = 0.5;
+    double                      lp_share = 0.5;
+    double                      lp_flow = 0.02;
+    uint64_t                    seed = 1;
+    unsigned                    threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t                      grain = 4;
+};
+
+struct configuration {
+    std::string     label;
+    pool::converter pool;
+};
+
+struct outcome {
+    double lp_return = 0;   // %
+    double vs_hodl = 0;     // %
+    double fees = 0;        // % of the initial pool value
+    double slippage = 0;    // bps
+    size_t rejected = 0;
+};
+
+using prices_t = std::map<std::string, double>;
+
+std::vector<std::string> split(const std::string& list, const char separator) {
+    std::vector<std::string> items;
+    for (size_t start = 0, end; start <= list.size(); start = end + 1) {
+        end = std::min(list.find(separator, start), list.size());
+        if (end > start) items.push_back(list.substr(start, end - start));
+    }
+    return items;
+}
+
+double units(const pool::converter& c, const std::string& symbol) {
+    if (symbol == c.currency) return pool::to_units(c.supply, pool::SMART_TOKEN_PRECISION);
+    const pool::reserve& r = c.reserves.at(symbol);
+    return pool::to_units(r.balance, r.precision);
+}
+
+// the value of one `symbol` in `base` at the pool's spot prices, the smart token priced like `emit_price_data_event`
+double spot_price(const pool::converter& c, const std::string& base, const std::string& symbol) {
+    const double base_per_weight = units(c, base) / c.reserves.at(base).weight;
+    if (symbol == c.currency) return base_per_weight * curves::MAX_WEIGHT / units(c, c.currency);
+    return base_per_weight * c.reserves.at(symbol).weight / units(c, symbol);
+}
+
+// the value of one `symbol` in the base reserve at the external prices
+double market_price(const pool::converter& c, const prices_t& prices, const std::string& symbol) {
+    if (symbol != c.currency) return prices.at(symbol);
+
+    double value = 0;
+    for (const auto& r : c.reserves) value += units(c, r.first) * prices.at(r.first);
+    return value / units(c, c.currency);
+}
+
+// converts between `a` and `b` in the direction and with the amount that profits the most at the external prices
+void arbitrage(pool::converter& c, const std::string& a, const std::string& b, const prices_t& prices, double& fees) {
+    // the pool sells the token it prices below the market
+    const bool buy_b = prices.at(b) / prices.at(a) > spot_price(c, a, b);
+    const std::string& from = buy_b ? a : b;
+    const std::string& to = buy_b ? b : a;
+    const uint8_t from_precision = c.reserves.at(from).precision, to_precision = c.reserves.at(to).precision;
+
+    const auto profit = [&](const int64_t amount) {
+        const pool::conversion result = pool::quote(c, from, to, amount);
+        return pool::to_units(result.amount, to_precision) * prices.at(to) - pool::to_units(amount, from_precision) * prices.at(from);
+    };
+
+    // the profit is concave in the amount, up to the truncation of the return
+    double low = 1, high = c.reserves.at(from).balance;
+    for (int i = 0; i < 60 && high - low > 1; i++) {
+        const double m1 = low + (high - low) / 3, m2 = high - (high - low) / 3;
+        if (profit(m1) < profit(m2)) low = m1;
+        else high = m2;
+    }
+    const int64_t amount = low;
+    if (profit(amount) <= 0) return;
+
+    const pool::conversion result = pool::convert(c, from, to, amount);
+    fees += result.fee * prices.at(to);
+}
+
+outcome simulate(const pool::converter& initial, const std::string& base, const options& opts, const size_t scenario) {
+    std::mt19937_64 rng(opts.seed * 1000003 + scenario);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+    std::exponential_distribution<double> trade_size(1 / opts.trade_size);
+
+    pool::converter c = initial;
+    std::vector<std::string> tokens{ c.currency };
+    prices_t prices;
+    for (const auto& r : c.reserves) {
+        tokens.push_back(r.first);
+        prices[r.first] = spot_price(c, base, r.first);
+    }
+
+    // the simulated LP's share, and the reserve amounts it would hold instead
+    const int64_t lp_tokens = c.supply * opts.lp_share;
+    const double share = double(lp_tokens) / c.supply;
+    prices_t hodl;
+    double initial_value = 0;
+    for (const auto& r : c.reserves) {
+        hodl[r.first] = units(c, r.first) * share;
+        initial_value += hodl[r.first] * prices[r.first];
+    }
+
+    outcome result;
+    const double sigma = opts.volatility / sqrt(opts.steps);
+    double fees = 0, slippage = 0;
+    size_t trades = 0;
+    for (size_t step = 0; step < opts.steps; step++) {
+        for (auto& price : prices)
+            if (price.first != base) price.second *= exp(sigma * normal(rng) - sigma * sigma / 2);
+
+        for (const auto& r : initial.reserves)
+            if (r.first != base) arbitrage(c, base, r.first, prices, fees);
+
+        for (size_t t = 0; t < opts.trades; t++) {
+            const std::string& from = tokens[rng() % tokens.size()];
+            const std::string& to = tokens[rng() % tokens.size()];
+            if (from == to) continue;
+
+            const int64_t balance = from == c.currency ? c.supply : c.reserves.at(from).balance;
+            const int64_t amount = std::min(trade_size(rng), 0.1) * balance;
+            const pool::conversion quote = amount > 0 ? pool::quote(c, from, to, amount) : pool::conversion{ 0, 0 };
+            if (quote.amount <= 0) { // below min return
+                result.rejected++;
+                continue;
+            }
+
+            const double rate = spot_price(c, base, from) / spot_price(c, base, to);
+            const double to_units = pool::to_units(quote.amount, pool::precision_of(c, to));
+            slippage += 1 - (to_units + quote.fee) / (pool::to_units(amount, pool::precision_of(c, from)) * rate);
+            trades++;
+
+            fees += quote.fee * market_price(c, prices, to);
+            pool::apply(c, from, to, amount, quote);
+        }
+
+        if (uniform(rng) < opts.lp_flow) {
+            const int64_t amount = uniform(rng) * 2 * opts.trade_size * c.supply;
+            if (rng() & 1) pool::fund(c, amount);
+            else if (amount > 0) pool::liquidate(c, std::min(amount, c.supply - lp_tokens));
+        }
+    }
+
+    // the LP liquidates its share at the end
+    double lp_value = 0, hodl_value = 0;
+    pool::converter final_pool = c;
+    const std::vector<int64_t> returns = pool::liquidate(final_pool, lp_tokens);
+    size_t i = 0;
+    for (const auto& r : c.reserves) {
+        lp_value += pool::to_units(returns[i++], r.second.precision) * prices[r.first];
+        hodl_value += hodl[r.first] * prices[r.first];
+    }
+
+    result.lp_return = (lp_value / initial_value - 1) * 100;
+    result.vs_hodl = (lp_value / hodl_value - 1) * 100;
+    result.fees = fees / (initial_value / share) * 100;
+    result.slippage = trades ? slippage / trades * 1e4 : 0;
+    return result;
+}
+
+void report(const configuration& config, std::vector<outcome>::const_iterator begin, std::vector<outcome>::const_iterator end) {
+    const double percentiles[] = { 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99 };
+    printf("\n%s\n%-16s %10s %10s %10s %10s %10s %10s %10s %10s\n", config.label.c_str(), "", "mean", "p1", "p5", "p25", "p50", "p75", "p95", "p99");
+
+    const auto row = [&](const char* name, double outcome::* metric) {
+        std::vector<double> values;
+        for (auto itr = begin; itr != end; itr++) values.push_back((*itr).*metric);
+        std::sort(values.begin(), values.end());
+
+        double sum = 0;
+        for (const double value : values) sum += value;
+        printf("%-16s %10.4f", name, sum / values.size());
+        for (const double p : percentiles) printf(" %10.4f", values[std::min(values.size() - 1, size_t(p * values.size()))]);
+        printf("\n");
+    };
+    row("LP return %", &outcome::lp_return);
+    row("LP vs HODL %", &outcome::vs_hodl);
+    row("fees % of pool", &outcome::fees);
+    row("slippage bps", &outcome::slippage);
+
+    size_t rejected = 0;
+    for (auto itr = begin; itr != end; itr++) rejected += itr->rejected;
+    printf("rejected trades  %zu\n", rejected);
+}
+
+options parse_options(const int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 == argc) throw std::runtime_error(arg + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--state") opts.state_file = value();
+        else if (arg == "--converter") opts.converter = value();
+        else if (arg == "--reserves") opts.reserves = value();
+        else if (arg == "--supply") opts.supply = std::stod(value());
+        else if (arg == "--fee") opts.fees = value();
+        else if (arg == "--weights") opts.weights = value();
+        else if (arg == "--base") opts.base = value();
+        else if (arg == "--scenarios") opts.scenarios = std::stoul(value());
+        else if (arg == "--steps") opts.steps = std::stoul(value());
+        else if (arg == "--trades") opts.trades = std::stoul(value());
+        else if (arg == "--trade-size") opts.trade_size = std::stod(value());
+        else if (arg == "--volatility") opts.volatility = std::stod(value());
+        else if (arg == "--lp-share") opts.lp_share = std::stod(value());
+        else if (arg == "--lp-flow") opts.lp_flow = std::stod(value());
+        else if (arg == "--seed") opts.seed = std::stoull(value());
+        else if (arg == "--threads") opts.threads = std::max(1, std::stoi(value()));
+        else if (arg == "--grain") opts.grain = std::max(1ul, std::stoul(value()));
+        else throw std::runtime_error("unknown argument " + arg);
+    }
+    if (!opts.state_file.empty() && opts.converter.empty()) throw std::runtime_error("--state needs --converter");
+    if (!opts.scenarios || !opts.steps) throw std::runtime_error("no scenarios to run");
+    if (opts.trade_size <= 0 || opts.lp_share <= 0 || opts.lp_share > 1) throw std::runtime_error("invalid trade size or LP share");
+    return opts;
+}
+
+// the simulated pool, from a `converters` table dump or from `--reserves` (symbol:precision:weight:balance) and `--supply`
+pool::converter load_pool(const options& opts) {
+    if (!opts.state_file.empty()) {
+        for (const pool::converter& c : pool::load_converters_file(opts.state_file))
+            if (c.currency == opts.converter) return c;
+        throw std::runtime_error("converter " + opts.converter + " not found in " + opts.state_file);
+    }
+
+    pool::converter c;
+    c.currency = opts.converter.empty() ? "POOL" : opts.converter;
+    c.supply = pool::round_amount(opts.supply, pool::SMART_TOKEN_PRECISION);
+    c.fee = 2500;
+    for (const std::string& entry : split(opts.reserves, ',')) {
+        const std::vector<std::string> fields = split(entry, ':');
+        if (fields.size() != 4) throw std::runtime_error("invalid reserve '" + entry + "', expected symbol:precision:weight:balance");
+
+        pool::reserve& r = c.reserves[fields[0]];
+        r.precision = std::stoi(fields[1]);
+        r.weight = std::stoull(fields[2]);
+        r.balance = pool::round_amount(std::stod(fields[3]), r.precision);
+    }
+    return c;
+}
+
+// the `fee` x `weights` sweep over the loaded pool
+std::vector<configuration> configurations(const options& opts, const pool::converter& c) {
+    std::vector<std::string> fees = split(opts.fees, ',');
+    if (fees.empty()) fees.push_back(std::to_string(c.fee));
+    std::vector<std::string> weight_sets = split(opts.weights, ';');
+    if (weight_sets.empty()) weight_sets.push_back("");
+
+    std::vector<configuration> configs;
+    for (const std::string& fee : fees)
+        for (const std::string& weights : weight_sets) {
+            configuration config{ "", c };
+            config.pool.fee = std::stoull(fee);
+            if (config.pool.fee >= curves::MAX_FEE) throw std::runtime_error("fee must be below " + std::to_string(uint64_t(curves::MAX_FEE)));
+
+            for (const std::string& entry : split(weights, ',')) {
+                const size_t eq = entry.find('=');
+                const auto r = config.pool.reserves.find(entry.substr(0, eq));
+                if (eq == std::string::npos || r == config.pool.reserves.end()) throw std::runtime_error("invalid weight '" + entry + "'");
+                r->second.weight = std::stoull(entry.substr(eq + 1));
+            }
+            if (config.pool.total_weight() > curves::MAX_WEIGHT) throw std::runtime_error("total reserve weight exceeds 100%");
+
+            config.label = config.pool.currency + " fee " + std::to_string(config.pool.fee) + ", weights";
+            for (const auto& r : config.pool.reserves) config.label += " " + r.first + "=" + std::to_string(r.second.weight);
+            configs.push_back(config);
+        }
+    return configs;
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    pool::converter initial;
+    std::vector<configuration> configs;
+    std::string base;
+    try {
+        opts = parse_options(argc, argv);
+        initial = load_pool(opts);
+        if (initial.reserves.size() < 2) throw std::runtime_error("the pool needs at least two reserves");
+        if (!initial.supply) throw std::runtime_error("the pool has no supply");
+
+        base = !opts.base.empty() ? opts.base : initial.reserves.count("BNT") ? "BNT" : initial.reserves.begin()->first;
+        if (!initial.reserves.count(base)) throw std::runtime_error("base reserve " + base + " not found");
+        configs = configurations(opts, initial);
+    }
+    catch (const std::exception& err) {
+        fprintf(stderr, "%s\nsee the usage in tools/montecarlo/montecarlo.cpp\n", err.what());
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<outcome> outcomes(configs.size() * opts.scenarios);
+    const work_stealing::stats stats = work_stealing::for_each(outcomes.size(), opts.threads, opts.grain, [&](const size_t i, unsigned) {
+        outcomes[i] = simulate(configs[i / opts.scenarios].pool, base, opts, i % opts.scenarios);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%zu scenarios x %zu steps x %zu configurations in %.2fs (%u threads, %zu steals), values in %s\n",
+           opts.scenarios, opts.steps, configs.size(), seconds, opts.threads, stats.steals, base.c_str());
+    for (size_t c = 0; c < configs.size(); c++)
+        report(configs[c], outcomes.begin() + c * opts.scenarios, outcomes.begin() + (c + 1) * opts.scenarios);
+    return 0;
+}
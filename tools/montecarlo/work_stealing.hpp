@@ -0,0 +1,116 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief work-stealing parallel loop for the host tools
+ * @details every worker starts with a contiguous share of the indices in its own deque. A worker splits the range it
+ * takes until it is `grain` indices long, pushing the upper halves back to its deque: it keeps working on the latest,
+ * smallest ranges (back), while idle workers steal the oldest, largest ones (front) from a random victim. Uneven task
+ * costs (e.g. scenarios that drain a pool early) are balanced without a shared queue every task goes through.
+ */
+namespace work_stealing {
+    struct range {
+        size_t begin;
+        size_t end;
+    };
+
+    struct stats {
+        size_t steals = 0;
+    };
+
+    class queue {
+        public:
+            void push(const range r) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _ranges.push_back(r);
+            }
+
+            // the owner takes the latest range
+            bool pop(range& r) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_ranges.empty()) return false;
+                r = _ranges.back();
+                _ranges.pop_back();
+                return true;
+            }
+
+            // thieves take the oldest range
+            bool steal(range& r) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_ranges.empty()) return false;
+                r = _ranges.front();
+                _ranges.pop_front();
+                return true;
+            }
+
+        private:
+            std::mutex          _mutex;
+            std::deque<range>   _ranges;
+    };
+
+    // calls `f(index, worker)` for every index in [0, count) on `threads` workers, rethrows the first exception of `f`
+    template <typename F>
+    stats for_each(const size_t count, unsigned threads, const size_t grain, F&& f) {
+        threads = std::max(1u, threads);
+        std::vector<queue> queues(threads);
+        for (unsigned t = 0; t < threads; t++)
+            queues[t].push({ count * t / threads, count * (t + 1) / threads });
+
+        std::atomic<size_t> remaining{ count };
+        std::atomic<size_t> steals{ 0 };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        const auto work = [&](const unsigned worker) {
+            std::minstd_rand rng(worker + 1);
+            while (remaining.load() > 0) {
+                range r;
+                bool found = queues[worker].pop(r);
+                for (unsigned attempt = 0; !found && attempt < threads - 1; attempt++) {
+                    const unsigned victim = (worker + 1 + rng() % (threads - 1)) % threads;
+                    if ((found = queues[victim].steal(r))) steals++;
+                }
+                if (!found) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                while (r.end - r.begin > std::max<size_t>(grain, 1)) {
+                    const size_t mid = r.begin + (r.end - r.begin) / 2;
+                    queues[worker].push({ mid, r.end });
+                    r.end = mid;
+                }
+                for (size_t i = r.begin; i < r.end; i++) {
+                    try {
+                        f(i, worker);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error) error = std::current_exception();
+                    }
+                }
+                remaining -= r.end - r.begin;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(work, t);
+        work(0);
+        for (auto& worker : workers) worker.join();
+
+        if (error) std::rethrow_exception(error);
+        return { steals.load() };
+    }
+}
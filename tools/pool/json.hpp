@@ -0,0 +1,178 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include <stdlib.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief minimal JSON reader for the host tools
+ * @details enough for `get_table_rows` results and action traces: objects keep their key order,
+ * numbers are doubles and strings only unescape the escapes `events.hpp` writes (`\uXXXX` is kept below 0x80)
+ */
+namespace json {
+    struct value {
+        enum kind_t { null, boolean, number, string, array, object };
+
+        kind_t                                      kind = null;
+        bool                                        b = false;
+        double                                      n = 0;
+        std::string                                 s;
+        std::vector<value>                          items;
+        std::vector<std::pair<std::string, value>>  members;
+
+        // the member `key` of an object, nullptr if missing
+        const value* find(const std::string& key) const {
+            for (const auto& member : members)
+                if (member.first == key) return &member.second;
+            return nullptr;
+        }
+
+        const value& operator[](const std::string& key) const {
+            const value* member = find(key);
+            if (!member) throw std::runtime_error("missing key '" + key + "'");
+            return *member;
+        }
+
+        // numbers and numeric strings, as nodeos prints 64 bit integers as either
+        double as_number() const {
+            if (kind == number) return n;
+            if (kind == string) return strtod(s.c_str(), nullptr);
+            throw std::runtime_error("not a number");
+        }
+
+        const std::string& as_string() const {
+            if (kind != string) throw std::runtime_error("not a string");
+            return s;
+        }
+    };
+
+    class parser {
+        public:
+            explicit parser(const std::string& text) : _text(text) {}
+
+            value parse() {
+                value result = parse_value();
+                skip_whitespace();
+                if (_pos != _text.size()) fail("trailing characters");
+                return result;
+            }
+
+        private:
+            const std::string&  _text;
+            size_t              _pos = 0;
+
+            [[noreturn]] void fail(const char* message) {
+                throw std::runtime_error(std::string(message) + " at offset " + std::to_string(_pos));
+            }
+
+            void skip_whitespace() {
+                while (_pos < _text.size() && (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\n' || _text[_pos] == '\r'))
+                    _pos++;
+            }
+
+            bool consume(const char c) {
+                skip_whitespace();
+                if (_pos < _text.size() && _text[_pos] == c) {
+                    _pos++;
+                    return true;
+                }
+                return false;
+            }
+
+            void expect(const char c) {
+                if (!consume(c)) fail("unexpected character");
+            }
+
+            bool consume_literal(const char* literal, const size_t len) {
+                if (_text.compare(_pos, len, literal) != 0) return false;
+                _pos += len;
+                return true;
+            }
+
+            value parse_value() {
+                skip_whitespace();
+                if (_pos == _text.size()) fail("unexpected end");
+
+                value result;
+                const char c = _text[_pos];
+                if (c == '{') {
+                    result.kind = value::object;
+                    _pos++;
+                    if (consume('}')) return result;
+                    do {
+                        skip_whitespace();
+                        std::string key = parse_string();
+                        expect(':');
+                        result.members.emplace_back(std::move(key), parse_value());
+                    } while (consume(','));
+                    expect('}');
+                }
+                else if (c == '[') {
+                    result.kind = value::array;
+                    _pos++;
+                    if (consume(']')) return result;
+                    do result.items.push_back(parse_value());
+                    while (consume(','));
+                    expect(']');
+                }
+                else if (c == '"') {
+                    result.kind = value::string;
+                    result.s = parse_string();
+                }
+                else if (consume_literal("true", 4)) {
+                    result.kind = value::boolean;
+                    result.b = true;
+                }
+                else if (consume_literal("false", 5)) result.kind = value::boolean;
+                else if (consume_literal("null", 4)) result.kind = value::null;
+                else {
+                    char* end;
+                    result.kind = value::number;
+                    result.n = strtod(_text.c_str() + _pos, &end);
+                    if (end == _text.c_str() + _pos) fail("invalid value");
+                    _pos = end - _text.c_str();
+                }
+                return result;
+            }
+
+            std::string parse_string() {
+                if (_pos == _text.size() || _text[_pos] != '"') fail("expected string");
+                _pos++;
+
+                std::string result;
+                while (_pos < _text.size() && _text[_pos] != '"') {
+                    char c = _text[_pos++];
+                    if (c == '\\') {
+                        if (_pos == _text.size()) break;
+                        switch (c = _text[_pos++]) {
+                            case 'n': c = '\n'; break;
+                            case 'r': c = '\r'; break;
+                            case 't': c = '\t'; break;
+                            case 'b': c = '\b'; break;
+                            case 'f': c = '\f'; break;
+                            case 'u':
+                                if (_pos + 4 > _text.size()) fail("invalid escape");
+                                c = static_cast<char>(strtol(_text.substr(_pos, 4).c_str(), nullptr, 16));
+                                _pos += 4;
+                                break;
+                        }
+                    }
+                    result += c;
+                }
+                if (_pos == _text.size()) fail("unterminated string");
+                _pos++;
+                return result;
+            }
+    };
+
+    inline value parse(const std::string& text) {
+        return parser(text).parse();
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include "../../contracts/eos/Common/curves.hpp"
+
+#include <math.h>
+#include <stdint.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @defgroup Pool Pool
+ * @brief host model of a multi-converter pool
+ * @details mirrors `BancorConverter::calculate_return` and the balance changes of `apply_conversion`, `fund` and
+ * `liquidate` on top of the contract's own formulas (`curves.hpp`), including the conversions between raw asset
+ * amounts and token units (`asset_to_double`, `double_to_asset`, `to_fixed`).
+ * Balances and supply are raw asset amounts like in the `converters` table, build with `-ffp-contract=off` to
+ * match the contract's (never fused) arithmetic.
+ * @{
+ */
+namespace pool {
+    constexpr uint8_t SMART_TOKEN_PRECISION = 4; // BancorConverter::DEFAULT_TOKEN_PRECISION
+
+    struct reserve {
+        int64_t     balance = 0;
+        uint64_t    weight = 0;
+        uint8_t     precision = 4;
+        std::string contract;
+    };
+
+    struct converter {
+        std::string                     currency;   // smart token symbol code
+        int64_t                         supply = 0;
+        uint64_t                        fee = 0;
+        std::map<std::string, reserve>  reserves;   // by symbol code
+        uint64_t                        version = 0; // `converters_t::version`, 0 if the row has none
+
+        double total_weight() const {
+            double total = 0;
+            for (const auto& r : reserves) total += r.second.weight;
+            return total;
+        }
+    };
+
+    // a conversion return after the fee, as `double_to_asset` truncates it, and the fee as `to_fixed` rounds it
+    struct conversion {
+        int64_t amount;
+        double  fee;
+    };
+
+    // asset_to_double
+    inline double to_units(const int64_t amount, const uint8_t precision) {
+        return amount / pow(10, precision);
+    }
+
+    // double_to_asset
+    inline int64_t to_amount(const double units, const uint8_t precision) {
+        return static_cast<int64_t>(units * pow(10, precision));
+    }
+
+    // the nearest raw amount, for units read back from logs or snapshots
+    inline int64_t round_amount(const double units, const uint8_t precision) {
+        return llround(units * pow(10, precision));
+    }
+
+    // to_fixed, which truncates through an `int`: fees of 2^31 raw units and more don't survive it on chain
+    inline double to_fixed(const double units, const uint8_t precision) {
+        return static_cast<int64_t>(units * pow(10.0, precision)) / pow(10.0, precision);
+    }
+
+    inline uint8_t precision_of(const converter& c, const std::string& symbol) {
+        return symbol == c.currency ? SMART_TOKEN_PRECISION : c.reserves.at(symbol).precision;
+    }
+
+    // BancorConverter::calculate_return, converting `amount` (raw, in `from`) to `to`
+    inline conversion quote(const converter& c, const std::string& from, const std::string& to, const int64_t amount) {
+        const bool incoming_smart_token = from == c.currency;
+        const bool outgoing_smart_token = to == c.currency;
+        if (incoming_smart_token == outgoing_smart_token && from == to) throw std::invalid_argument("cannot convert equivalent currencies");
+
+        const double supply = to_units(c.supply, SMART_TOKEN_PRECISION);
+        double to_units_amount;
+        if (!incoming_smart_token && !outgoing_smart_token) { // Reserve --> Reserve
+            const reserve& f = c.reserves.at(from);
+            const reserve& t = c.reserves.at(to);
+            to_units_amount = curves::cross_reserve_return(to_units(f.balance, f.precision), to_units(amount, f.precision), to_units(t.balance, t.precision), f.weight, t.weight);
+        }
+        else if (!incoming_smart_token) { // Reserve --> Smart
+            const reserve& f = c.reserves.at(from);
+            to_units_amount = curves::purchase_return(supply, to_units(f.balance, f.precision), to_units(amount, f.precision), f.weight);
+        }
+        else { // Smart --> Reserve
+            const reserve& t = c.reserves.at(to);
+            to_units_amount = curves::sale_return(supply, to_units(t.balance, t.precision), to_units(amount, SMART_TOKEN_PRECISION), t.weight);
+        }
+
+        const uint8_t magnitude = incoming_smart_token || outgoing_smart_token ? 1 : 2;
+        const uint8_t precision = precision_of(c, to);
+        const double fee = curves::conversion_fee(to_units_amount, c.fee, magnitude);
+        return { to_amount(to_units_amount - fee, precision), to_fixed(fee, precision) };
+    }
+
+    // BancorConverter::apply_conversion, the balance and supply changes of a conversion quoted with `quote`
+    inline void apply(converter& c, const std::string& from, const std::string& to, const int64_t amount, const conversion& result) {
+        if (from == c.currency) c.supply -= amount;
+        else c.reserves.at(from).balance += amount;
+
+        if (to == c.currency) c.supply += result.amount;
+        else c.reserves.at(to).balance -= result.amount;
+    }
+
+    inline conversion convert(converter& c, const std::string& from, const std::string& to, const int64_t amount) {
+        const conversion result = quote(c, from, to, amount);
+        apply(c, from, to, amount, result);
+        return result;
+    }
+
+    // BancorConverter::fund, the raw reserve amounts (in `reserves` order) paid for `amount` new smart tokens
+    inline std::vector<int64_t> fund(converter& c, const int64_t amount) {
+        const double total_weight = c.total_weight();
+        std::vector<int64_t> costs;
+        for (auto& r : c.reserves) {
+            const int64_t cost = ceil(curves::fund_cost(c.supply, r.second.balance, amount, total_weight));
+            r.second.balance += cost;
+            costs.push_back(cost);
+        }
+        c.supply += amount;
+        return costs;
+    }
+
+    // BancorConverter::liquidate, the raw reserve amounts (in `reserves` order) returned for retiring `amount` smart tokens
+    inline std::vector<int64_t> liquidate(converter& c, const int64_t amount) {
+        const double total_weight = c.total_weight();
+        std::vector<int64_t> returns;
+        for (auto& r : c.reserves) {
+            const int64_t result = curves::liquidate_return(c.supply, r.second.balance, amount, total_weight);
+            r.second.balance -= result;
+            returns.push_back(result);
+        }
+        c.supply -= amount;
+        return returns;
+    }
+}
+/** @}*/
@@ -0,0 +1,122 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include "json.hpp"
+#include "pool.hpp"
+
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief reads `pool::converter`s from the multi-converter's `converters` table,
+ * as `cleos get table <contract> <contract> converters -l -1` (or `get_table_rows`) prints it
+ */
+namespace pool {
+    struct parsed_asset {
+        int64_t     amount;
+        uint8_t     precision;
+        std::string symbol;
+    };
+
+    // "1000.00000000 BNT" --> { 100000000000, 8, "BNT" }, parsed from the digits so no amount is rounded
+    inline parsed_asset parse_asset(const std::string& quantity) {
+        const size_t space = quantity.find(' ');
+        if (space == std::string::npos) throw std::runtime_error("invalid asset '" + quantity + "'");
+
+        parsed_asset result{ 0, 0, quantity.substr(space + 1) };
+        bool negative = false, decimals = false;
+        for (size_t i = 0; i < space; i++) {
+            const char c = quantity[i];
+            if (c == '-' && i == 0) negative = true;
+            else if (c == '.' && !decimals) decimals = true;
+            else if (c >= '0' && c <= '9') {
+                result.amount = result.amount * 10 + (c - '0');
+                if (decimals) result.precision++;
+            }
+            else throw std::runtime_error("invalid asset '" + quantity + "'");
+        }
+        if (negative) result.amount = -result.amount;
+        return result;
+    }
+
+    // { 100000000000, 8 } --> "1000.00000000"
+    inline std::string format_amount(const int64_t amount, const uint8_t precision) {
+        std::string digits = std::to_string(amount < 0 ? -amount : amount);
+        if (digits.size() <= precision) digits.insert(0, precision + 1 - digits.size(), '0');
+        if (precision) digits.insert(digits.size() - precision, ".");
+        return amount < 0 ? "-" + digits : digits;
+    }
+
+    // calls `f(key, value)` for the entries of a serialized map, written as `[{"key":k,"value":v}]`, `[[k,v]]` or `{k:v}`
+    inline void for_each_entry(const json::value& map, const std::function<void(const std::string&, const json::value&)>& f) {
+        if (map.kind == json::value::object) {
+            for (const auto& member : map.members) f(member.first, member.second);
+            return;
+        }
+        for (const auto& entry : map.items) {
+            if (entry.kind == json::value::array && entry.items.size() == 2) f(entry.items[0].as_string(), entry.items[1]);
+            else f(entry["key"].as_string(), entry["value"]);
+        }
+    }
+
+    // a `converters` row; converters created before the supply (version) was kept in the row are loaded with a zero supply (version)
+    inline converter load_converter(const json::value& row) {
+        converter c;
+        const std::string currency = row["currency"].as_string(); // "4,BNTEOS"
+        c.currency = currency.substr(currency.find(',') + 1);
+        c.fee = row["fee"].as_number();
+
+        for_each_entry(row["reserve_weights"], [&](const std::string& symbol, const json::value& weight) {
+            c.reserves[symbol].weight = weight.as_number();
+        });
+        for_each_entry(row["reserve_balances"], [&](const std::string& symbol, const json::value& balance) {
+            const parsed_asset quantity = parse_asset(balance["quantity"].as_string());
+            c.reserves[symbol].balance = quantity.amount;
+            c.reserves[symbol].precision = quantity.precision;
+            c.reserves[symbol].contract = balance["contract"].as_string();
+        });
+
+        // converters migrated to the flat reserves keep the maps empty
+        const json::value* reserves = row.find("reserves");
+        if (reserves && reserves->kind == json::value::array) {
+            for (const json::value& record : reserves->items) {
+                const parsed_asset quantity = parse_asset(record["balance"]["quantity"].as_string());
+                reserve& r = c.reserves[record["symbol"].as_string()];
+                r.weight = record["weight"].as_number();
+                r.balance = quantity.amount;
+                r.precision = quantity.precision;
+                r.contract = record["balance"]["contract"].as_string();
+            }
+        }
+
+        const json::value* supply = row.find("supply");
+        if (supply && supply->kind == json::value::string) c.supply = parse_asset(supply->s).amount;
+        const json::value* version = row.find("version");
+        if (version && version->kind != json::value::null) c.version = version->as_number();
+        return c;
+    }
+
+    // the rows of a table dump, either the `get_table_rows` result (`{"rows":[...]}`) or the bare rows array
+    inline std::vector<converter> load_converters(const json::value& table) {
+        const json::value* rows = table.kind == json::value::object ? &table["rows"] : &table;
+
+        std::vector<converter> result;
+        for (const auto& row : rows->items) result.push_back(load_converter(row));
+        return result;
+    }
+
+    inline std::vector<converter> load_converters_file(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("cannot read " + path);
+
+        std::stringstream text;
+        text << file.rdbuf();
+        return load_converters(json::parse(text.str()));
+    }
+}
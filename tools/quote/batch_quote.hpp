@@ -0,0 +1,289 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include "../../contracts/eos/Common/curves.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_QUOTE_X86 1
+#endif
+
+/**
+ * @defgroup BatchQuote BatchQuote
+ * @brief off-chain batch quotes for a single converter
+ * @details evaluates many candidate trade amounts against one pool in a single call, returning for each
+ * amount what `BancorConverter::calculate_return` would return before it is truncated to the token precision:
+ * - `purchase_returns` - reserve --> smart token
+ * - `sale_returns` - smart token --> reserve
+ * - `cross_reserve_returns` - reserve --> reserve, with the double (`magnitude` 2) conversion fee
+ *
+ * all amounts and balances are in token units (as `asset_to_double` returns them), weights in ppm and fees in
+ * ppm of the converter `fee`.
+ * 100% and 50% weights use the same specializations as the contract (`curves.hpp`) and match it exactly when
+ * built with `-ffp-contract=off` (the contract's arithmetic is never fused). Other weights use 4-wide AVX2
+ * `log`/`exp` kernels accurate to a few ulp; the `x^F - 1` cancellation of very small trades amplifies that to
+ * ~1e-10 of the return, still far below the precision the returns are truncated to.
+ * CPUs without AVX2/FMA (and non x86 builds) fall back to a scalar loop over the contract formulas.
+ * @{
+ */
+namespace batch_quote {
+    constexpr double MAX_FEE = 1000000.0;
+
+    // the share of a return taken as the conversion fee, `calculate_fee(amount, fee, magnitude) == amount * fee_rate(fee, magnitude)`
+    inline double fee_rate(const uint64_t fee, const uint8_t magnitude) {
+        return 1 - pow((1 - fee / MAX_FEE), magnitude);
+    }
+
+    inline double deduct_fee(const double amount, const double fee_rate) {
+        return amount - amount * fee_rate;
+    }
+
+    namespace scalar {
+        inline void purchase_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, double fee_rate) {
+            for (size_t i = 0; i < count; i++)
+                returns[i] = deduct_fee(curves::purchase_return(supply, balance, amounts[i], weight), fee_rate);
+        }
+
+        inline void sale_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, double fee_rate) {
+            for (size_t i = 0; i < count; i++)
+                returns[i] = deduct_fee(curves::sale_return(supply, balance, amounts[i], weight), fee_rate);
+        }
+
+        inline void cross_reserve_returns(const double* amounts, double* returns, size_t count, double from_balance, double from_weight, double to_balance, double to_weight, double fee_rate) {
+            for (size_t i = 0; i < count; i++)
+                returns[i] = deduct_fee(curves::cross_reserve_return(from_balance, amounts[i], to_balance, from_weight, to_weight), fee_rate);
+        }
+    }
+
+#ifdef BATCH_QUOTE_X86
+    namespace avx2 {
+        #define BATCH_QUOTE_AVX2 __attribute__((target("avx2,fma")))
+
+        // e^x, |error| < 2 ulp for x in [-708, 709], 0 below and +inf above that range
+        BATCH_QUOTE_AVX2 inline __m256d exp(const __m256d x) {
+            const __m256d magic = _mm256_set1_pd(6755399441055744.0); // 1.5 * 2^52, rounds to an integer in the low mantissa bits
+            const __m256d t = _mm256_fmadd_pd(x, _mm256_set1_pd(1.4426950408889634), magic);
+            const __m256d n = _mm256_sub_pd(t, magic);
+
+            // r = x - n * ln(2), in two parts to keep the low bits of ln(2)
+            __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(6.93147180369123816490e-01), x);
+            r = _mm256_fnmadd_pd(n, _mm256_set1_pd(1.90821492927058770002e-10), r);
+
+            // e^r for |r| <= ln(2) / 2, taylor series up to r^12 / 12!, evaluated with Estrin's scheme to shorten the fma chain
+            const __m256d r2 = _mm256_mul_pd(r, r), r4 = _mm256_mul_pd(r2, r2), r8 = _mm256_mul_pd(r4, r4);
+            const __m256d p0 = _mm256_fmadd_pd(_mm256_set1_pd(1.0), r, _mm256_set1_pd(1.0));
+            const __m256d p1 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 6.0), r, _mm256_set1_pd(0.5));
+            const __m256d p2 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 120.0), r, _mm256_set1_pd(1.0 / 24.0));
+            const __m256d p3 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 5040.0), r, _mm256_set1_pd(1.0 / 720.0));
+            const __m256d p4 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 362880.0), r, _mm256_set1_pd(1.0 / 40320.0));
+            const __m256d p5 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 39916800.0), r, _mm256_set1_pd(1.0 / 3628800.0));
+            const __m256d q0 = _mm256_fmadd_pd(p1, r2, p0);
+            const __m256d q1 = _mm256_fmadd_pd(p3, r2, p2);
+            const __m256d q2 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 479001600.0), r4, _mm256_fmadd_pd(p5, r2, p4));
+            const __m256d p = _mm256_fmadd_pd(q2, r8, _mm256_fmadd_pd(q1, r4, q0));
+
+            // 2^n, built from the integer left in the low bits of t
+            const __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52);
+            __m256d result = _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+
+            result = _mm256_blendv_pd(result, _mm256_setzero_pd(), _mm256_cmp_pd(x, _mm256_set1_pd(-708.0), _CMP_LT_OQ));
+            return _mm256_blendv_pd(result, _mm256_set1_pd(HUGE_VAL), _mm256_cmp_pd(x, _mm256_set1_pd(709.0), _CMP_GT_OQ));
+        }
+
+        // ln(x) for normal positive x, |error| < 2 ulp
+        BATCH_QUOTE_AVX2 inline __m256d log(const __m256d x) {
+            const __m256i bits = _mm256_castpd_si256(x);
+
+            // x = m * 2^e, m in [1, 2)
+            const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+            const __m256i biased = _mm256_srli_epi64(bits, 52);
+            __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(two52))), two52);
+            e = _mm256_sub_pd(e, _mm256_set1_pd(1023.0));
+
+            const __m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL));
+            __m256d m = _mm256_castsi256_pd(_mm256_or_si256(mantissa, _mm256_set1_epi64x(0x3ff0000000000000LL)));
+
+            // m in [sqrt(1/2), sqrt(2)) keeps |s| below 0.172
+            const __m256d large = _mm256_cmp_pd(m, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+            m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), large);
+            e = _mm256_add_pd(e, _mm256_and_pd(large, _mm256_set1_pd(1.0)));
+
+            // ln(m) = 2 * atanh(s), s = (m - 1) / (m + 1), series up to s^21 / 21 evaluated with Estrin's scheme
+            const __m256d one = _mm256_set1_pd(1.0);
+            const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+            const __m256d z = _mm256_mul_pd(s, s), z2 = _mm256_mul_pd(z, z), z4 = _mm256_mul_pd(z2, z2), z8 = _mm256_mul_pd(z4, z4);
+            const __m256d p0 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 5.0), z, _mm256_set1_pd(1.0 / 3.0));
+            const __m256d p1 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 9.0), z, _mm256_set1_pd(1.0 / 7.0));
+            const __m256d p2 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 13.0), z, _mm256_set1_pd(1.0 / 11.0));
+            const __m256d p3 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 17.0), z, _mm256_set1_pd(1.0 / 15.0));
+            const __m256d p4 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 21.0), z, _mm256_set1_pd(1.0 / 19.0));
+            const __m256d q0 = _mm256_fmadd_pd(p1, z2, p0);
+            const __m256d q1 = _mm256_fmadd_pd(p3, z2, p2);
+            const __m256d p = _mm256_mul_pd(_mm256_fmadd_pd(p4, z8, _mm256_fmadd_pd(q1, z4, q0)), z);
+            const __m256d ln_m = _mm256_fmadd_pd(_mm256_add_pd(s, s), p, _mm256_add_pd(s, s));
+
+            // e * ln(2) + ln(m), ln(2) in two parts
+            const __m256d result = _mm256_fmadd_pd(e, _mm256_set1_pd(6.93147180369123816490e-01),
+                                   _mm256_fmadd_pd(e, _mm256_set1_pd(1.90821492927058770002e-10), ln_m));
+            return result;
+        }
+
+        // base ^ exponent for base >= 0 (0 ^ exponent is 0)
+        BATCH_QUOTE_AVX2 inline __m256d pow(const __m256d base, const __m256d exponent) {
+            const __m256d result = exp(_mm256_mul_pd(exponent, log(base)));
+            return _mm256_blendv_pd(result, _mm256_setzero_pd(), _mm256_cmp_pd(base, _mm256_setzero_pd(), _CMP_LE_OQ));
+        }
+
+        BATCH_QUOTE_AVX2 inline __m256d deduct_fee(const __m256d amount, const __m256d fee_rate) {
+            return _mm256_sub_pd(amount, _mm256_mul_pd(amount, fee_rate));
+        }
+
+        // applies `kernel` to every 4 amounts, the remainder is padded and written back partially
+        // 4 vectors are handed out per iteration, their independent log/exp chains hide each other's latency
+        template <typename F>
+        BATCH_QUOTE_AVX2 inline void for_each_batch(const double* amounts, double* returns, size_t count, F&& kernel) {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m256d r0 = kernel(_mm256_loadu_pd(amounts + i));
+                const __m256d r1 = kernel(_mm256_loadu_pd(amounts + i + 4));
+                const __m256d r2 = kernel(_mm256_loadu_pd(amounts + i + 8));
+                const __m256d r3 = kernel(_mm256_loadu_pd(amounts + i + 12));
+                _mm256_storeu_pd(returns + i, r0);
+                _mm256_storeu_pd(returns + i + 4, r1);
+                _mm256_storeu_pd(returns + i + 8, r2);
+                _mm256_storeu_pd(returns + i + 12, r3);
+            }
+            for (; i + 4 <= count; i += 4)
+                _mm256_storeu_pd(returns + i, kernel(_mm256_loadu_pd(amounts + i)));
+
+            if (i < count) {
+                double in[4] = { 0, 0, 0, 0 }, out[4];
+                for (size_t j = 0; i + j < count; j++) in[j] = amounts[i + j];
+                _mm256_storeu_pd(out, kernel(_mm256_loadu_pd(in)));
+                for (size_t j = 0; i + j < count; j++) returns[i + j] = out[j];
+            }
+        }
+
+        BATCH_QUOTE_AVX2 inline void purchase_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, double fee_rate) {
+            const __m256d S = _mm256_set1_pd(supply), C = _mm256_set1_pd(balance), one = _mm256_set1_pd(1.0);
+            const __m256d F = _mm256_set1_pd(weight / curves::MAX_WEIGHT), fee = _mm256_set1_pd(fee_rate);
+            const __m256d inverse_C = _mm256_set1_pd(1.0 / balance);
+
+            switch (curves::classify(weight)) {
+                case curves::weight_class::full:
+                    return for_each_batch(amounts, returns, count, [&](__m256d T) BATCH_QUOTE_AVX2 {
+                        return deduct_fee(_mm256_div_pd(_mm256_mul_pd(S, T), C), fee);
+                    });
+                case curves::weight_class::half:
+                    return for_each_batch(amounts, returns, count, [&](__m256d T) BATCH_QUOTE_AVX2 {
+                        const __m256d root = _mm256_sqrt_pd(_mm256_add_pd(one, _mm256_div_pd(T, C)));
+                        return deduct_fee(_mm256_mul_pd(S, _mm256_sub_pd(root, one)), fee);
+                    });
+                default: // the pow kernel isn't exact anyway, so the division is traded for a multiplication
+                    return for_each_batch(amounts, returns, count, [&](__m256d T) BATCH_QUOTE_AVX2 {
+                        const __m256d power = pow(_mm256_fmadd_pd(T, inverse_C, one), F);
+                        return deduct_fee(_mm256_mul_pd(S, _mm256_sub_pd(power, one)), fee);
+                    });
+            }
+        }
+
+        BATCH_QUOTE_AVX2 inline void sale_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, double fee_rate) {
+            const __m256d S = _mm256_set1_pd(supply), C = _mm256_set1_pd(balance), one = _mm256_set1_pd(1.0);
+            const __m256d F = _mm256_set1_pd(curves::MAX_WEIGHT / weight), fee = _mm256_set1_pd(fee_rate);
+            const __m256d inverse_S = _mm256_set1_pd(1.0 / supply);
+
+            switch (curves::classify(weight)) {
+                case curves::weight_class::full:
+                    return for_each_batch(amounts, returns, count, [&](__m256d E) BATCH_QUOTE_AVX2 {
+                        return deduct_fee(_mm256_div_pd(_mm256_mul_pd(C, E), S), fee);
+                    });
+                case curves::weight_class::half:
+                    return for_each_batch(amounts, returns, count, [&](__m256d E) BATCH_QUOTE_AVX2 {
+                        const __m256d base = _mm256_sub_pd(one, _mm256_div_pd(E, S));
+                        return deduct_fee(_mm256_mul_pd(C, _mm256_sub_pd(one, _mm256_mul_pd(base, base))), fee);
+                    });
+                default:
+                    return for_each_batch(amounts, returns, count, [&](__m256d E) BATCH_QUOTE_AVX2 {
+                        const __m256d power = pow(_mm256_fnmadd_pd(E, inverse_S, one), F);
+                        return deduct_fee(_mm256_mul_pd(C, _mm256_sub_pd(one, power)), fee);
+                    });
+            }
+        }
+
+        BATCH_QUOTE_AVX2 inline void cross_reserve_returns(const double* amounts, double* returns, size_t count, double from_balance, double from_weight, double to_balance, double to_weight, double fee_rate) {
+            const __m256d from = _mm256_set1_pd(from_balance), to = _mm256_set1_pd(to_balance), one = _mm256_set1_pd(1.0);
+            const __m256d F = _mm256_set1_pd(from_weight / to_weight), fee = _mm256_set1_pd(fee_rate);
+
+            if (from_weight == to_weight)
+                return for_each_batch(amounts, returns, count, [&](__m256d T) BATCH_QUOTE_AVX2 {
+                    return deduct_fee(_mm256_mul_pd(_mm256_div_pd(T, _mm256_add_pd(from, T)), to), fee);
+                });
+
+            for_each_batch(amounts, returns, count, [&](__m256d T) BATCH_QUOTE_AVX2 {
+                const __m256d power = pow(_mm256_div_pd(from, _mm256_add_pd(from, T)), F);
+                return deduct_fee(_mm256_mul_pd(to, _mm256_sub_pd(one, power)), fee);
+            });
+        }
+
+        inline bool supported() {
+            static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            return avx2;
+        }
+
+        #undef BATCH_QUOTE_AVX2
+    }
+#endif
+
+    /**
+     * @brief reserve --> smart token returns for each of `count` reserve amounts
+     * @param supply - smart token supply
+     * @param balance - reserve balance
+     * @param weight - reserve weight (ppm)
+     * @param fee - converter fee (ppm)
+     */
+    inline void purchase_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, uint64_t fee) {
+        const double rate = fee_rate(fee, 1);
+#ifdef BATCH_QUOTE_X86
+        if (avx2::supported()) return avx2::purchase_returns(amounts, returns, count, supply, balance, weight, rate);
+#endif
+        scalar::purchase_returns(amounts, returns, count, supply, balance, weight, rate);
+    }
+
+    /**
+     * @brief smart token --> reserve returns for each of `count` smart token amounts
+     * @param supply - smart token supply
+     * @param balance - reserve balance
+     * @param weight - reserve weight (ppm)
+     * @param fee - converter fee (ppm)
+     */
+    inline void sale_returns(const double* amounts, double* returns, size_t count, double supply, double balance, double weight, uint64_t fee) {
+        const double rate = fee_rate(fee, 1);
+#ifdef BATCH_QUOTE_X86
+        if (avx2::supported()) return avx2::sale_returns(amounts, returns, count, supply, balance, weight, rate);
+#endif
+        scalar::sale_returns(amounts, returns, count, supply, balance, weight, rate);
+    }
+
+    /**
+     * @brief reserve --> reserve returns for each of `count` 'from' reserve amounts, the fee is charged twice
+     * @param from_balance - 'from' reserve balance
+     * @param from_weight - 'from' reserve weight (ppm)
+     * @param to_balance - 'to' reserve balance
+     * @param to_weight - 'to' reserve weight (ppm)
+     * @param fee - converter fee (ppm)
+     */
+    inline void cross_reserve_returns(const double* amounts, double* returns, size_t count, double from_balance, double from_weight, double to_balance, double to_weight, uint64_t fee) {
+        const double rate = fee_rate(fee, 2);
+#ifdef BATCH_QUOTE_X86
+        if (avx2::supported()) return avx2::cross_reserve_returns(amounts, returns, count, from_balance, from_weight, to_balance, to_weight, rate);
+#endif
+        scalar::cross_reserve_returns(amounts, returns, count, from_balance, from_weight, to_balance, to_weight, rate);
+    }
+}
+/** @}*/
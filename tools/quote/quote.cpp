@@ -0,0 +1,158 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief quotes conversion paths over a snapshot of the multi-converter's pools and keeps the quotes up to date
+ *  through the changed rows of every block (tools/quote/quote_cache.hpp)
+ *
+ *  usage: quote <converters.json> <paths.txt> [--updates updates.jsonl] [--quiet]
+ *
+ *  `converters.json` is a `converters` table dump (`cleos get table multiconvert multiconvert converters -l -1`).
+ *  every line of `paths.txt` is an amount and a memo path, "10.0000 EOS multiconvert:BNTEOS BNT multiconvert:BNTUSD USD".
+ *  every line of `--updates` holds the rows of one block, as a row or a table dump; rows with an unchanged `version` are
+ *  skipped and only the quotes through the changed converters are recomputed. `--quiet` only prints the totals
+ */
+#include "pool/json.hpp"
+#include "pool/snapshot.hpp"
+#include "quote/quote_cache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct options {
+    std::string state_file;
+    std::string paths_file;
+    std::string updates_file;
+    bool        quiet = false;
+};
+
+struct request {
+    pool::parsed_asset  amount;
+    std::string         text;
+    quote_cache::path   path;
+};
+
+options parse_options(const int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 == argc) throw std::runtime_error(arg + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--updates") opts.updates_file = value();
+        else if (arg == "--quiet") opts.quiet = true;
+        else if (arg[0] != '-' && opts.state_file.empty()) opts.state_file = arg;
+        else if (arg[0] != '-' && opts.paths_file.empty()) opts.paths_file = arg;
+        else throw std::runtime_error("unknown argument " + arg);
+    }
+    if (opts.paths_file.empty()) throw std::runtime_error("no converters snapshot and paths given");
+    return opts;
+}
+
+std::vector<request> load_requests(const std::string& file_name) {
+    std::ifstream file(file_name);
+    if (!file) throw std::runtime_error("cannot read " + file_name);
+
+    std::vector<request> requests;
+    for (std::string line; std::getline(file, line);) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos) continue;
+
+        const size_t amount_end = line.find(' ', line.find(' ') + 1);
+        if (amount_end == std::string::npos) throw std::runtime_error("invalid path line '" + line + "'");
+        requests.push_back({ pool::parse_asset(line.substr(0, amount_end)), line, quote_cache::parse_path(line.substr(amount_end + 1)) });
+    }
+    return requests;
+}
+
+// the return of a request, "" if a converter on its path is unknown or the path is invalid
+std::string quote(quote_cache::cache& cache, const request& r) {
+    try {
+        const quote_cache::quote& q = cache.get(r.amount.symbol, r.path, r.amount.amount);
+        const std::string& to = r.path.back().to;
+        return pool::format_amount(q.amount, pool::precision_of(cache.converter(r.path.back().converter), to)) + " " + to;
+    }
+    catch (const std::exception&) {
+        return "";
+    }
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    std::vector<request> requests;
+    std::vector<pool::converter> converters;
+    try {
+        opts = parse_options(argc, argv);
+        converters = pool::load_converters_file(opts.state_file);
+        requests = load_requests(opts.paths_file);
+    }
+    catch (const std::exception& err) {
+        fprintf(stderr, "%s\nsee the usage in tools/quote/quote.cpp\n", err.what());
+        return 2;
+    }
+
+    quote_cache::cache cache;
+    for (const pool::converter& c : converters) cache.update(c);
+
+    std::vector<std::string> quotes;
+    for (const request& r : requests) {
+        quotes.push_back(quote(cache, r));
+        if (!opts.quiet) printf("%s --> %s\n", r.text.c_str(), quotes.back().empty() ? "no quote" : quotes.back().c_str());
+    }
+    if (opts.updates_file.empty()) return 0;
+    const size_t initial_misses = cache.statistics().misses;
+
+    std::ifstream updates(opts.updates_file);
+    if (!updates) {
+        fprintf(stderr, "cannot read %s\n", opts.updates_file.c_str());
+        return 2;
+    }
+
+    size_t line_number = 0, total_changed = 0;
+    double total_us = 0;
+    for (std::string line; std::getline(updates, line);) {
+        line_number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::vector<pool::converter> rows;
+        try {
+            const json::value update = json::parse(line);
+            if (update.kind == json::value::object && !update.find("rows")) rows = { pool::load_converter(update) };
+            else rows = pool::load_converters(update);
+        }
+        catch (const std::exception& err) {
+            fprintf(stderr, "update %zu: %s\n", line_number, err.what());
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t misses = cache.statistics().misses;
+        size_t changed = 0;
+        for (const pool::converter& c : rows) changed += cache.update(c);
+
+        std::vector<size_t> moved;
+        for (size_t i = 0; i < requests.size(); i++) {
+            std::string now = quote(cache, requests[i]);
+            if (now != quotes[i]) moved.push_back(i);
+            quotes[i] = std::move(now);
+        }
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        total_changed += changed;
+        total_us += us;
+
+        if (opts.quiet) continue;
+        printf("\nupdate %zu: %zu of %zu rows changed, %zu of %zu quotes recomputed in %.0fus\n", line_number, changed, rows.size(),
+               cache.statistics().misses - misses, requests.size(), us);
+        for (const size_t i : moved)
+            printf("  %s --> %s\n", requests[i].text.c_str(), quotes[i].empty() ? "no quote" : quotes[i].c_str());
+    }
+
+    const quote_cache::stats& stats = cache.statistics();
+    printf("\n%zu updates, %zu converters changed, %zu quotes recomputed and %zu served from the cache in %.0fus\n",
+           line_number, total_changed, stats.misses - initial_misses, stats.hits, total_us);
+    return 0;
+}
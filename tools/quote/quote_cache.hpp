@@ -0,0 +1,142 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ */
+#pragma once
+
+#include "pool/pool.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @defgroup QuoteCache QuoteCache
+ * @brief path quotes over the multi-converter's pools, kept until a pool they cross changes
+ * @details `cache` holds the latest `converters` rows and the quotes of the paths asked for. Rows are compared by
+ * their `version`, which the contract bumps on every change of a converter's reserves or fee: a row with the version
+ * already held is ignored, and a newer one drops only the quotes of the paths through that converter. Feeding every
+ * block's table rows to `update` therefore recomputes the quotes in proportion to the pools that changed.
+ * Rows without a version (version 0, converters not modified since versions were added) are compared field by field.
+ * Not thread safe, a router shares one cache behind its own lock or keeps one per thread.
+ * @{
+ */
+namespace quote_cache {
+    struct hop {
+        std::string converter;  // smart token symbol code
+        std::string to;         // symbol code
+    };
+
+    using path = std::vector<hop>;
+
+    // the path of a conversion memo, "multiconvert:BNTEOS BNT multiconvert:BNTUSD USD", converter accounts are dropped
+    inline path parse_path(const std::string& text) {
+        std::vector<std::string> elements;
+        for (size_t start = 0, end; start < text.size(); start = end + 1) {
+            end = std::min(text.find(' ', start), text.size());
+            if (end > start) elements.push_back(text.substr(start, end - start));
+        }
+        if (elements.empty() || elements.size() % 2) throw std::invalid_argument("invalid path '" + text + "'");
+
+        path result;
+        for (size_t i = 0; i < elements.size(); i += 2) {
+            const std::string& converter = elements[i];
+            result.push_back({ converter.substr(converter.find(':') + 1), elements[i + 1] });
+        }
+        return result;
+    }
+
+    struct quote {
+        int64_t                         amount = 0; // raw, in the last hop's token
+        std::vector<pool::conversion>   hops;
+    };
+
+    struct stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t invalidated = 0;
+    };
+
+    class cache {
+        public:
+            // stores a converter row, returns whether its state changed, which drops the quotes through it;
+            // rows older than the one held (a lagging API node) are ignored
+            bool update(const pool::converter& c) {
+                const auto itr = _converters.find(c.currency);
+                if (itr != _converters.end() && !newer(itr->second, c)) return false;
+
+                _converters[c.currency] = c;
+                const auto paths = _by_converter.find(c.currency);
+                if (paths == _by_converter.end()) return true;
+                for (const std::string& key : paths->second) _stats.invalidated += _quotes.erase(key);
+                _by_converter.erase(paths);
+                return true;
+            }
+
+            // the return of `amount` (raw, in `from`) sent along `p`, throws `std::out_of_range` for unknown converters
+            const quote& get(const std::string& from, const path& p, const int64_t amount) {
+                std::string key = from + " " + std::to_string(amount);
+                for (const hop& h : p) key += " " + h.converter + " " + h.to;
+
+                const auto itr = _quotes.find(key);
+                if (itr != _quotes.end()) {
+                    _stats.hits++;
+                    return itr->second;
+                }
+
+                const quote& result = _quotes.emplace(key, compute(from, p, amount)).first->second;
+                _stats.misses++;
+                for (const hop& h : p) _by_converter[h.converter].insert(key);
+                return result;
+            }
+
+            const pool::converter& converter(const std::string& currency) const {
+                const auto itr = _converters.find(currency);
+                if (itr == _converters.end()) throw std::out_of_range("unknown converter " + currency);
+                return itr->second;
+            }
+
+            size_t size() const { return _quotes.size(); }
+            const stats& statistics() const { return _stats; }
+
+        private:
+            std::map<std::string, pool::converter>                              _converters;
+            std::unordered_map<std::string, quote>                              _quotes;
+            std::unordered_map<std::string, std::unordered_set<std::string>>    _by_converter;  // quote keys through every converter
+            stats                                                               _stats;
+
+            static bool newer(const pool::converter& held, const pool::converter& row) {
+                if (held.version || row.version) return row.version > held.version;
+                if (held.supply != row.supply || held.fee != row.fee || held.reserves.size() != row.reserves.size()) return true;
+                for (const auto& r : row.reserves) {
+                    const auto itr = held.reserves.find(r.first);
+                    if (itr == held.reserves.end() || itr->second.balance != r.second.balance || itr->second.weight != r.second.weight ||
+                        itr->second.precision != r.second.precision || itr->second.contract != r.second.contract) return true;
+                }
+                return false;
+            }
+
+            // the hops run one after another on chain, a converter crossed twice sees the state left by the earlier hop
+            quote compute(const std::string& from, const path& p, int64_t amount) const {
+                std::map<std::string, pool::converter> touched;
+                quote result;
+                std::string symbol = from;
+                for (const hop& h : p) {
+                    auto itr = touched.find(h.converter);
+                    if (itr == touched.end()) itr = touched.emplace(h.converter, converter(h.converter)).first;
+
+                    const pool::conversion conversion = pool::convert(itr->second, symbol, h.to, amount);
+                    result.hops.push_back(conversion);
+                    amount = conversion.amount;
+                    symbol = h.to;
+                }
+                result.amount = amount;
+                return result;
+            }
+    };
+}
+/** @}*/
@@ -0,0 +1,487 @@
+/**
+ *  @file
+ *  @copyright defined in ../../LICENSE
+ *  @brief replays historical `conversion` and `price_data` log actions of the multi-converter through the host
+ *  converter model (tools/pool), rebuilding every pool over time and reporting where the recomputed `return`
+ *  and `conversion_fee` diverge from the logged ones
+ *
+ *  usage: replay <log.jsonl> [--state converters.json] [--precision BNT=8,EOS=4] [--threads 8] [--tolerance 1e-6] [--report 20] [--print-state]
+ *
+ *  the log holds one `log` action per line, either its data (`{"event":"conversion","version":"1.4","data":...}`)
+ *  or an action trace with the data under `act` (`trx_id` and `block_num` are reported along divergences);
+ *  `data` is the `map<string, string>` of `emit_conversion_event`, `emit_price_data_event` and
+ *  `emit_conversion_fee_update_event`, in any of the JSON map forms nodeos and history services print
+ *
+ *  pools are rebuilt from the events alone:
+ *  - `price_data` events are the reserve balance, weight and smart token supply after a balance change; a conversion
+ *    logs them before its own `conversion` event, so the state the conversion was computed on is the logged
+ *    state with the conversion's amounts reversed, and a book that disagrees with it is reported as a state gap
+ *  - without `price_data` (converters with `events` mode `conversion`) the replayed state is carried forward
+ *  - fees come from `conversion_fee_update` events, else they are inferred from the first large enough conversion
+ *  - `--state` seeds the pools (and the reserve precisions) from a `converters` table dump taken before the log starts,
+ *    otherwise reserve precisions come from `--precision` (default 4) and a pool is verified once its reserves were logged
+ *
+ *  logged amounts are printed with 6 decimals (`to_string`), the replayed ones are compared after the same rounding;
+ *  conversions involving tokens with more decimals than that are replayed on rounded amounts, so for them one unit
+ *  of the returned token's precision is accepted on top of `--tolerance` (default one unit of the 6th decimal)
+ *  converters are independent, `--threads` replays them in parallel (the log is parsed in parallel too).
+ *  exits with 1 if any divergence was found
+ */
+#include "pool/json.hpp"
+#include "pool/pool.hpp"
+#include "pool/snapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr double MIN_FEE_INFERENCE_RETURN = 10.0; // token units, ppm fees can't be recovered from smaller printed returns
+
+struct options {
+    std::string                     log_file;
+    std::string                     state_file;
+    std::map<std::string, uint8_t>  precisions;
+    unsigned                        threads = std::max(1u, std::thread::hardware_concurrency());
+    double                          tolerance = 1e-6;
+    size_t                          report = 20;
+    bool                            print_state = false;
+
+    uint8_t precision(const std::string& symbol) const {
+        const auto itr = precisions.find(symbol);
+        return itr == precisions.end() ? 4 : itr->second;
+    }
+};
+
+struct event {
+    enum kind_t { conversion, price_data, fee_update };
+
+    kind_t      kind;
+    size_t      line;
+    std::string where;      // block and transaction of traces
+    std::string converter;
+
+    std::string from, to;                       // conversion
+    double      amount = 0, to_return = 0, fee = 0;
+
+    std::string reserve;                        // price_data
+    double      supply = 0, balance = 0, weight = 0;
+
+    uint64_t    new_fee = 0;                    // conversion_fee_update
+};
+
+struct divergence {
+    size_t      line;
+    std::string where;
+    std::string converter;
+    std::string what;
+    double      logged;
+    double      replayed;
+};
+
+struct replay_result {
+    std::string             converter;
+    size_t                  conversions = 0;
+    size_t                  verified = 0;
+    size_t                  unverified = 0;
+    bool                    fee_inferred = false;
+    std::vector<divergence> divergences;
+    pool::converter         book;
+};
+
+// the value a logged `to_string(double)` holds
+double printed(const double value) {
+    return std::stod(std::to_string(value));
+}
+
+// parses one log line, nullopt for lines of other actions and events
+std::optional<event> parse_event(const std::string& text, const size_t line) {
+    const json::value root = json::parse(text);
+    const json::value* log = &root;
+
+    std::string where;
+    if (const json::value* act = root.find("act")) {
+        const json::value* name = act->find("name");
+        if (name && name->kind == json::value::string && name->s != "log") return std::nullopt;
+        log = &(*act)["data"];
+
+        if (const json::value* block = root.find("block_num")) where += "block " + std::to_string((uint64_t)block->as_number());
+        if (const json::value* trx = root.find("trx_id")) where += (where.empty() ? "trx " : " trx ") + trx->as_string();
+    }
+
+    std::map<std::string, std::string> data;
+    pool::for_each_entry((*log)["data"], [&](const std::string& key, const json::value& value) {
+        data[key] = value.as_string();
+    });
+    const auto field = [&](const char* key) -> const std::string& {
+        const auto itr = data.find(key);
+        if (itr == data.end()) throw std::runtime_error(std::string("missing data field '") + key + "'");
+        return itr->second;
+    };
+    const auto number = [&](const char* key) { return std::stod(field(key)); };
+
+    event e;
+    e.line = line;
+    e.where = where;
+
+    const std::string& name = (*log)["event"].as_string();
+    if (name == "conversion") {
+        e.kind = event::conversion;
+        e.from = field("from_symbol");
+        e.to = field("to_symbol");
+        e.amount = number("amount");
+        e.to_return = number("return");
+        e.fee = number("conversion_fee");
+    }
+    else if (name == "price_data") {
+        e.kind = event::price_data;
+        e.reserve = field("reserve_symbol");
+        e.supply = number("smart_supply");
+        e.balance = number("reserve_balance");
+        e.weight = number("reserve_ratio");
+    }
+    else if (name == "conversion_fee_update") {
+        e.kind = event::fee_update;
+        e.new_fee = std::stoull(field("new_fee"));
+    }
+    else return std::nullopt;
+
+    e.converter = field("converter_currency_symbol");
+    return e;
+}
+
+class replayer {
+    public:
+        replayer(const options& opts, const std::string& converter, const pool::converter* initial) : _opts(opts) {
+            _result.converter = converter;
+            _result.book.currency = converter;
+            if (!initial) return;
+
+            _result.book = *initial;
+            for (const auto& reserve : initial->reserves) _known.insert(reserve.first);
+            _supply_known = initial->supply > 0;
+            _fee_known = true;
+        }
+
+        replay_result run(const std::vector<const event*>& events) {
+            for (const event* e : events) {
+                switch (e->kind) {
+                    case event::price_data: on_price_data(*e); break;
+                    case event::conversion: on_conversion(*e); break;
+                    case event::fee_update:
+                        _result.book.fee = e->new_fee;
+                        _fee_known = true;
+                        break;
+                }
+            }
+            for (const auto& obs : _pending) settle(_result.book, *obs.second);
+            settle_supply(_result.book);
+            return std::move(_result);
+        }
+
+    private:
+        const options&                          _opts;
+        replay_result                           _result;
+        std::set<std::string>                   _known;         // reserves with a known balance
+        bool                                    _supply_known = false;
+        bool                                    _fee_known = false;
+        std::map<std::string, const event*>     _pending;       // latest `price_data` per reserve, not yet matched to a conversion
+        const event*                            _pending_supply = nullptr; // latest `price_data`, the supply after its change
+
+        pool::reserve& reserve(pool::converter& book, const std::string& symbol) {
+            const auto itr = book.reserves.find(symbol);
+            if (itr != book.reserves.end()) return itr->second;
+
+            pool::reserve& created = book.reserves[symbol];
+            created.precision = _opts.precision(symbol);
+            return created;
+        }
+
+        uint8_t precision(pool::converter& book, const std::string& symbol) {
+            return symbol == book.currency ? pool::SMART_TOKEN_PRECISION : reserve(book, symbol).precision;
+        }
+
+        void diverge(const event& e, const std::string& what, const double logged, const double replayed) {
+            _result.divergences.push_back({ e.line, e.where, _result.converter, what, logged, replayed });
+        }
+
+        // applies a logged reserve balance change
+        void settle(pool::converter& book, const event& obs) {
+            pool::reserve& r = reserve(book, obs.reserve);
+            r.balance = pool::round_amount(obs.balance, r.precision);
+            r.weight = llround(obs.weight);
+            _known.insert(obs.reserve);
+        }
+
+        // applies the latest logged supply
+        void settle_supply(pool::converter& book) {
+            if (!_pending_supply) return;
+            book.supply = pool::round_amount(_pending_supply->supply, pool::SMART_TOKEN_PRECISION);
+            _supply_known = true;
+            _pending_supply = nullptr;
+        }
+
+        void on_price_data(const event& e) {
+            // the previous change of this reserve wasn't a conversion (fund, liquidate, withdrawal)
+            const auto itr = _pending.find(e.reserve);
+            if (itr != _pending.end()) settle(_result.book, *itr->second);
+
+            // the supply logged along the previous change is the one this change was made on
+            settle_supply(_result.book);
+            _pending[e.reserve] = &e;
+            _pending_supply = &e;
+        }
+
+        void on_conversion(const event& e) {
+            _result.conversions++;
+
+            pool::converter before = _result.book;
+            const bool from_smart = e.from == before.currency;
+            const bool to_smart = e.to == before.currency;
+            const int64_t amount = pool::round_amount(e.amount, precision(before, e.from));
+            const int64_t to_return = pool::round_amount(e.to_return, precision(before, e.to));
+
+            // the state before the conversion: the logged state after it, with the conversion reversed
+            std::vector<std::string> involved;
+            if (!from_smart) involved.push_back(e.from);
+            if (!to_smart) involved.push_back(e.to);
+
+            bool complete = true;
+            std::vector<const event*> observed;
+            for (const std::string& symbol : involved) {
+                const auto itr = _pending.find(symbol);
+                if (itr == _pending.end()) {
+                    complete &= _known.count(symbol) > 0;
+                    continue;
+                }
+                const event& obs = *itr->second;
+                observed.push_back(&obs);
+
+                pool::reserve& r = reserve(before, symbol);
+                const int64_t balance = pool::round_amount(obs.balance, r.precision) - (symbol == e.from ? amount : -to_return);
+
+                // logged balances of tokens with more than 6 decimals are rounded
+                const int64_t slack = r.precision > 6 ? 2 * pow(10, r.precision - 6) : 0;
+                if (_known.count(symbol) && llabs(r.balance - balance) > slack)
+                    diverge(e, symbol + " balance before conversion", pool::to_units(balance, r.precision), pool::to_units(r.balance, r.precision));
+
+                r.balance = balance;
+                r.weight = llround(obs.weight);
+                _known.insert(symbol);
+            }
+
+            // the last `price_data` is this conversion's when it logged any, otherwise it preceded the conversion
+            if (observed.empty()) settle_supply(before);
+            else {
+                const int64_t supply = pool::round_amount(_pending_supply->supply, pool::SMART_TOKEN_PRECISION) - (to_smart ? to_return : 0) + (from_smart ? amount : 0);
+                if (_supply_known && before.supply != supply)
+                    diverge(e, "supply before conversion", pool::to_units(supply, pool::SMART_TOKEN_PRECISION), pool::to_units(before.supply, pool::SMART_TOKEN_PRECISION));
+                before.supply = supply;
+                _supply_known = true;
+            }
+            if (from_smart || to_smart) complete &= _supply_known;
+
+            if (!_fee_known) {
+                const double total = e.to_return + e.fee;
+                if (total >= MIN_FEE_INFERENCE_RETURN) {
+                    const double magnitude = from_smart || to_smart ? 1 : 2;
+                    before.fee = llround((1 - pow(1 - e.fee / total, 1 / magnitude)) * curves::MAX_FEE);
+                    _result.fee_inferred = _fee_known = true;
+                }
+                else complete = false;
+            }
+
+            if (complete) {
+                try {
+                    const pool::conversion result = pool::quote(before, e.from, e.to, amount);
+                    const double replayed_return = printed(pool::to_units(result.amount, precision(before, e.to)));
+                    const double replayed_fee = printed(result.fee);
+                    const size_t divergences = _result.divergences.size();
+
+                    // the rounding of logged amounts of tokens with more than 6 decimals can move a return across the
+                    // truncation to its token's precision, i.e. by one unit of it
+                    bool rounded_inputs = false;
+                    for (const std::string& symbol : involved) rounded_inputs |= reserve(before, symbol).precision > 6;
+                    const double tolerance = _opts.tolerance + 1e-9 + (rounded_inputs ? pow(10, -precision(before, e.to)) : 0);
+
+                    if (fabs(replayed_return - e.to_return) > tolerance) diverge(e, "return", e.to_return, replayed_return);
+                    if (fabs(replayed_fee - e.fee) > tolerance) diverge(e, "conversion_fee", e.fee, replayed_fee);
+                    if (divergences == _result.divergences.size()) _result.verified++;
+
+                    // the book follows the logged return, a divergence is reported once
+                    pool::apply(before, e.from, e.to, amount, { to_return, e.fee });
+                }
+                catch (const std::exception& err) {
+                    diverge(e, std::string("replay failed: ") + err.what(), e.to_return, 0);
+                }
+            }
+            else _result.unverified++;
+
+            // carry on from the logged state where there is one
+            for (const event* obs : observed) {
+                settle(before, *obs);
+                _pending.erase(obs->reserve);
+            }
+            settle_supply(before);
+            _result.book = before;
+        }
+};
+
+std::vector<std::string> read_lines(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot read " + path);
+
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) lines.push_back(std::move(line));
+    return lines;
+}
+
+// runs `f(i)` for i in [0, count) over `threads` threads, handing out indices one at a time
+template <typename F>
+void parallel_for(const size_t count, const unsigned threads, F&& f) {
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::min<size_t>(threads, count); t++)
+        workers.emplace_back([&] {
+            for (size_t i; (i = next++) < count;) f(i);
+        });
+    for (auto& worker : workers) worker.join();
+}
+
+options parse_options(const int argc, char** argv) {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 == argc) throw std::runtime_error(arg + " needs a value");
+            return argv[++i];
+        };
+
+        if (arg == "--state") opts.state_file = value();
+        else if (arg == "--threads") opts.threads = std::max(1, std::stoi(value()));
+        else if (arg == "--tolerance") opts.tolerance = std::stod(value());
+        else if (arg == "--report") opts.report = std::stoul(value());
+        else if (arg == "--print-state") opts.print_state = true;
+        else if (arg == "--precision") {
+            const std::string list = value();
+            for (size_t start = 0, end; start < list.size(); start = end + 1) {
+                end = std::min(list.find(',', start), list.size());
+                const std::string entry = list.substr(start, end - start);
+                const size_t eq = entry.find('=');
+                if (eq == std::string::npos) throw std::runtime_error("invalid precision '" + entry + "', expected SYMBOL=decimals");
+                opts.precisions[entry.substr(0, eq)] = std::stoi(entry.substr(eq + 1));
+            }
+        }
+        else if (arg[0] != '-' && opts.log_file.empty()) opts.log_file = arg;
+        else throw std::runtime_error("unknown argument " + arg);
+    }
+    if (opts.log_file.empty()) throw std::runtime_error("no log file given");
+    return opts;
+}
+
+int main(int argc, char** argv) {
+    options opts;
+    try {
+        opts = parse_options(argc, argv);
+    }
+    catch (const std::exception& err) {
+        fprintf(stderr, "%s\nusage: replay <log.jsonl> [--state converters.json] [--precision BNT=8,EOS=4] [--threads N] [--tolerance 1e-6] [--report 20] [--print-state]\n", err.what());
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> lines;
+    std::map<std::string, pool::converter> initial;
+    try {
+        lines = read_lines(opts.log_file);
+        if (!opts.state_file.empty())
+            for (pool::converter& c : pool::load_converters_file(opts.state_file)) {
+                for (const auto& reserve : c.reserves) opts.precisions.emplace(reserve.first, reserve.second.precision);
+                initial[c.currency] = std::move(c);
+            }
+    }
+    catch (const std::exception& err) {
+        fprintf(stderr, "%s\n", err.what());
+        return 2;
+    }
+
+    // parse in parallel, in chunks of lines
+    constexpr size_t CHUNK = 4096;
+    std::vector<std::optional<event>> parsed(lines.size());
+    std::vector<std::string> errors(lines.size());
+    parallel_for((lines.size() + CHUNK - 1) / CHUNK, opts.threads, [&](const size_t chunk) {
+        for (size_t i = chunk * CHUNK; i < std::min(lines.size(), (chunk + 1) * CHUNK); i++) {
+            if (lines[i].find_first_not_of(" \t\r") == std::string::npos) continue;
+            try {
+                parsed[i] = parse_event(lines[i], i + 1);
+            }
+            catch (const std::exception& err) {
+                errors[i] = err.what();
+            }
+        }
+    });
+
+    // converters in the order they first appear, each with its events in log order
+    std::vector<std::string> converters;
+    std::map<std::string, std::vector<const event*>> events;
+    size_t malformed = 0, replayed = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!errors[i].empty()) {
+            if (malformed++ < opts.report) fprintf(stderr, "line %zu: %s\n", i + 1, errors[i].c_str());
+            continue;
+        }
+        if (!parsed[i]) continue;
+
+        auto& converter_events = events[parsed[i]->converter];
+        if (converter_events.empty()) converters.push_back(parsed[i]->converter);
+        converter_events.push_back(&*parsed[i]);
+        replayed++;
+    }
+
+    std::vector<replay_result> results(converters.size());
+    parallel_for(converters.size(), opts.threads, [&](const size_t i) {
+        const auto itr = initial.find(converters[i]);
+        results[i] = replayer(opts, converters[i], itr == initial.end() ? nullptr : &itr->second).run(events[converters[i]]);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("replayed %zu events of %zu converters in %.2fs (%u threads)", replayed, converters.size(), seconds, opts.threads);
+    if (malformed) printf(", %zu malformed lines skipped", malformed);
+    printf("\n\n%-10s %12s %10s %11s %12s %8s\n", "converter", "conversions", "verified", "unverified", "divergences", "fee");
+
+    std::vector<divergence> divergences;
+    for (const replay_result& result : results) {
+        printf("%-10s %12zu %10zu %11zu %12zu %8llu%s\n", result.converter.c_str(), result.conversions, result.verified,
+               result.unverified, result.divergences.size(), (unsigned long long)result.book.fee, result.fee_inferred ? " (inferred)" : "");
+        divergences.insert(divergences.end(), result.divergences.begin(), result.divergences.end());
+    }
+
+    if (!divergences.empty()) {
+        std::sort(divergences.begin(), divergences.end(), [](const divergence& a, const divergence& b) { return a.line < b.line; });
+        printf("\n%zu divergences, first %zu:\n", divergences.size(), std::min(divergences.size(), opts.report));
+        for (size_t i = 0; i < std::min(divergences.size(), opts.report); i++) {
+            const divergence& d = divergences[i];
+            printf("  line %zu %s %s: logged %.8f, replayed %.8f%s%s\n", d.line, d.converter.c_str(), d.what.c_str(),
+                   d.logged, d.replayed, d.where.empty() ? "" : ", ", d.where.c_str());
+        }
+    }
+
+    if (opts.print_state) {
+        printf("\nfinal state:\n");
+        for (const replay_result& result : results) {
+            const pool::converter& book = result.book;
+            printf("  %s supply %.4f, fee %llu\n", book.currency.c_str(), pool::to_units(book.supply, pool::SMART_TOKEN_PRECISION), (unsigned long long)book.fee);
+            for (const auto& r : book.reserves)
+                printf("    %-8s %.*f weight %llu\n", r.first.c_str(), r.second.precision, pool::to_units(r.second.balance, r.second.precision), (unsigned long long)r.second.weight);
+        }
+    }
+
+    return divergences.empty() ? 0 : 1;
+}